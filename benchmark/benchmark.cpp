@@ -1,7 +1,9 @@
 
+#include <algorithm>
 #include <chrono>
 #include <iostream>
 #include <string>
+#include <thread>
 
 
 #include "convexHull2D.hpp"
@@ -10,6 +12,11 @@
 #include "gHull.cuh"
 #include "gHullSerial.hpp"
 #include "insertion3D.hpp"
+#include "parallel.hpp"
+#include "parallelHull3D.hpp"
+#include "quickHull3D.hpp"
+#include "randomizedHull3D.hpp"
+#include "voronoi.hpp"
 
 using namespace std;
 
@@ -25,8 +32,101 @@ using namespace std;
   }
 
 
-int main() {
+// Times each Voronoi engine on the three face tiles of the same projection
+void benchmarkVoronois() {
+  const size_t L = 512;
   
+  printf ( "%-8s %15s %15s %15s\n", "", "PBA GPU", "PBA CPU", "EDT CPU" );
+
+  for ( int sz : { 1000, 10000, 100000, 1000000, 10000000 } ) {
+    printf ( "%8d ", sz );
+    CompGeom::Geometry geom (3);
+    geom.addRandom(sz);
+
+    for ( auto engine : { PBA_GPU, PBA_CPU, EDT_CPU } ) {
+      // constructVoronois only reads the min faces
+      CompGeom::HullWorkspace ws ( L, engine, { Direction::LEFT, Direction::BACK, Direction::DOWN } );
+      projectToBox ( ws, geom, findExtremes2 ( geom ) );
+      timer ( constructVoronois ( ws ) );
+    }
+    printf("\n");
+    fflush(stdout);
+  }
+}
+
+// Times each phase of gHullSerial, with insertion3D on the same points
+void benchmarkPhases() {
+  printf ( "%-8s %15s %15s %15s %15s %15s %15s\n", "", "Projection", "Voronoi",
+	   "Working Sets", "Stars", "Splaying", "Insertion 3D" );
+
+  CompGeom::HullWorkspace ws;
+  for ( int sz : { 1000, 10000, 100000, 1000000, 10000000 } ) {
+    printf ( "%8d ", sz );
+    CompGeom::Geometry geom (3);
+    geom.addRandom(sz);
+
+    GHullTimings t;
+    gHullSerial ( geom, ws, DEFAULT_VORONOI_ENGINE, DEFAULT_RESOLUTION, &t );
+    printf ( "%15lf %15lf %15lf %15lf %15lf ", t.projection, t.voronoi, t.workingSets, t.stars, t.splaying );
+    timer ( insertion3D ( geom ) );
+    printf("\n");
+    fflush(stdout);
+  }
+}
+
+// Times hull on 1, 2, 4, ... threads up to every hardware thread, with the
+// serial hull it is compared to on the same points
+template < typename Serial, typename Hull >
+void benchmarkScaling ( const char *serialName, Serial serial, Hull hull ) {
+  vector < size_t > threads;
+  for ( size_t n=1; n<thread::hardware_concurrency(); n*=2 ) threads.push_back ( n );
+  threads.push_back ( max ( 1u, thread::hardware_concurrency() ) );
+
+  printf ( "%-8s %15s", "", serialName );
+  for ( auto n : threads ) printf ( " %12zu thr", n );
+  printf ( "\n" );
+
+  for ( int sz : { 100000, 1000000, 10000000 } ) {
+    printf ( "%8d ", sz );
+    CompGeom::Geometry geom (3);
+    geom.addRandom(sz);
+    timer ( serial ( geom ) );
+    for ( auto n : threads ) {
+      CompGeom::setNumThreads ( n );
+      timer ( hull ( geom ) );
+    }
+    CompGeom::setNumThreads ( 0 );
+    printf("\n");
+    fflush(stdout);
+  }
+}
+
+int main(int argc, char *argv[]) {
+  
+  if ( argc > 1 && string(argv[1]) == "voronoi" ) {
+    benchmarkVoronois();
+    return 0;
+  }
+
+  if ( argc > 1 && string(argv[1]) == "phases" ) {
+    benchmarkPhases();
+    return 0;
+  }
+
+  if ( argc > 1 && string(argv[1]) == "quickhull" ) {
+    benchmarkScaling ( "Insertion 3D",
+		       [] ( const CompGeom::Geometry &g ) { return insertion3D ( g ); },
+		       [] ( const CompGeom::Geometry &g ) { return quickHull3D ( g ); } );
+    return 0;
+  }
+
+  if ( argc > 1 && string(argv[1]) == "parallel" ) {
+    benchmarkScaling ( "Randomized 3D",
+		       [] ( const CompGeom::Geometry &g ) { return randomizedHull3D ( g ); },
+		       [] ( const CompGeom::Geometry &g ) { return parallelHull3D ( g ); } );
+    return 0;
+  }
+
 
   vector < int > sizes(200);
   generate(sizes.begin(),sizes.begin()+100,[] () {
@@ -43,12 +143,15 @@ int main() {
 	   "","Gift Wrap", "Graham Scan", "Monotone Chains",
 	   "Insertion 3D", "gHull Serial", "gHull");
 
+  // Shared by every gHullSerial call, as it would be when computing many hulls
+  CompGeom::HullWorkspace ws;
+
   for ( auto sz : sizes ) {
     printf ( "%8d ", sz );
     CompGeom::Geometry geom (3);
     geom.addRandom(sz);
     // timer ( gHullSerial (geom) );
-    timer ( gHullSerial (geom) );
+    timer ( gHullSerial (geom, ws) );
 
     // for ( const auto & func : {giftWrap, grahamScan} ) { 
     //   CompGeom::Geometry geom (2);
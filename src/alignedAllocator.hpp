@@ -0,0 +1,54 @@
+/******************************************************
+ * Name    : alignedAllocator.hpp
+ * Author  : Kevin Mooney
+ * Created : 17/10/26
+ * Updated :
+ *
+ * Description:
+ *   Allocator for std::vector that aligns the storage,
+ *   e.g. to the start of a cache line
+ *
+ * NOTES:
+ *   - Align must be a power of 2 and a multiple of
+ *     sizeof(void*), as for posix_memalign
+ ******************************************************/
+
+#pragma once
+
+#include <cstdlib>
+#include <new>
+
+#define CACHELINE 64		// Bytes in a cache line
+
+namespace CompGeom {
+
+  template < typename T, size_t Align = CACHELINE >
+  struct AlignedAllocator {
+    typedef T value_type;
+
+    template < typename U > struct rebind { typedef AlignedAllocator < U, Align > other; };
+
+    AlignedAllocator () {}
+    template < typename U >
+    AlignedAllocator ( const AlignedAllocator < U, Align > & ) {}
+
+    T *allocate ( size_t n ) {
+      void *p = NULL;
+      if ( n == 0 ) return NULL;
+      if ( posix_memalign ( &p, Align, n*sizeof(T) ) ) throw std::bad_alloc();
+      return static_cast < T * > ( p );
+    }
+
+    void deallocate ( T *p, size_t ) { free ( p ); }
+  };
+
+  template < typename T, typename U, size_t Align >
+  bool operator== ( const AlignedAllocator < T, Align > &, const AlignedAllocator < U, Align > & ) {
+    return true;
+  }
+
+  template < typename T, typename U, size_t Align >
+  bool operator!= ( const AlignedAllocator < T, Align > &, const AlignedAllocator < U, Align > & ) {
+    return false;
+  }
+}
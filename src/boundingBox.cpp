@@ -9,6 +9,8 @@
  * NOTES:
  ******************************************************/
 
+#include <algorithm>
+
 #include "boundingBox.hpp"
 #include "geometryHelper.hpp"
 
@@ -16,7 +18,17 @@ using namespace CompGeom;
 using namespace Direction;
 
 BoundingBox::BoundingBox ( const size_t &w ) 
-  : _T{std::vector<Tile>(6,Tile(w))}, _length{w} {}
+  : BoundingBox ( w, allDirections() ) {}
+
+BoundingBox::BoundingBox ( const size_t &w, const std::vector < Dir > &faces )
+  : _T{}, _length{w}
+{
+  _T.reserve ( 6 );
+  for ( auto dir : allDirections() ) {
+    bool used = std::find ( faces.begin(), faces.end(), dir ) != faces.end();
+    _T.emplace_back ( used ? w : 0 );
+  }
+}
 
 
 											 
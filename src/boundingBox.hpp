@@ -2,7 +2,7 @@
  * Name    : boundingBox.hpp
  * Author  : Kevin Mooney
  * Created : 25/07/16
- * Updated : 03/08/16
+ * Updated : 17/10/26
  *
  * Description:
  *
@@ -12,6 +12,8 @@
  *   way to do this
  *  - I originally wrote this with using the class in 
  *    CUDA too, this was a silly idea
+ *  - Faces left out of the constructor get an empty
+ *    tile, check hasFace before using one
  ******************************************************/
 
 #pragma once
@@ -30,8 +32,11 @@ namespace CompGeom {
     const size_t  _length;	// width, height and depth
   public:
     BoundingBox ( const size_t &w );
+    // Only allocates the tiles of the faces given
+    BoundingBox ( const size_t &w, const std::vector < Direction::Dir > &faces );
 
     size_t length() const { return _length; }    
+    bool   hasFace(enum Direction::Dir i) const { return _T[i].length() == _length; }
 
     Tile& operator[](enum Direction::Dir i) { return _T[i]; }
     const Tile& operator[](enum Direction::Dir i) const { return _T[i]; }
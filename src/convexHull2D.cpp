@@ -2,7 +2,7 @@
  * Name    : convexHull2D.cpp
  * Author  : Kevin Mooney
  * Created : 25/07/16
- * Updated : 03/08/16
+ * Updated : 17/10/26
  *
  * Description:
  *
@@ -10,15 +10,26 @@
  *  - Graham Scan last loop doesn't work as expected
  *    for large data sets, most likley a problem with
  *    the logic
+ *  - Gift wrap finds each point of the hull with the
+ *    batch predicates of predicates.hpp, the last step
+ *    of each is checked with orient2DExact
+ *  - Graham Scan turns use orient2DExact
+ *  - Integer points are wrapped one orientation at a
+ *    time, each is exact so there is nothing to check
  ******************************************************/
 
 #include <deque>
 #include <list>
 #include <vector>
 
+#include "convexHull2D.hpp"
+#include "exactPredicates.hpp"
 #include "geometry.hpp"
+#include "intPoints.hpp"
 #include "point.hpp"
 #include "pointOperations.hpp"
+#include "points.hpp"
+#include "predicates.hpp"
 
 using namespace std;
 
@@ -27,6 +38,10 @@ vector< size_t > giftWrap(const CompGeom::Geometry &geom) {
   if ( geom.getDim() != 2 ) {    
     errorM("Can only gift wrap 2D geometries\n");
   }  
+  return giftWrap ( CompGeom::Points<2> ( geom ) );
+}
+
+vector< size_t > giftWrap(const CompGeom::Points<2> &geom) {
   if ( geom.size() < 2 ) {
     errorM("Need more than 2 points to gift wrap\n");
   }
@@ -40,30 +55,43 @@ vector< size_t > giftWrap(const CompGeom::Geometry &geom) {
   size_t curID  = *min_element ( idx.begin(), idx.end(), 
 				 [&geom] ( size_t i, size_t j ) 
 				 {
-				   return geom[i][0] < geom[j][0];
+				   return geom.x(i) < geom.x(j);
 				 } );
 
-  CompGeom::Point dir_of_gift_wrap {{ 0,1 }};
-  CompGeom::Point dir_to_point     {{ 0,0 }};
+  const size_t n = geom.size();
+  const float *x = geom.axis(0), *y = geom.axis(1);
+  const float bound = CompGeom::orient2DErrorBound ( CompGeom::maxAbsCoord ( geom ) );
+  vector < float > side ( n );
 
-  // Loop until we arrive back to the start
+  // Loop until we arrive back to the start, going clockwise
+  // No point is left of the line to the next point. Starting from any
+  // other point, the point furthest left of the line to it takes its
+  // place until none are left, each step is one batch of orientations
   vector < size_t > cHull;
   do { 
     cHull.push_back ( curID ) ;
-    float max_angle = -numeric_limits<float>::max();	
-    nextID = -1;
-    // Find the smallest angle... contradictory naming convention 
-    for ( size_t i=0; i<geom.size(); i++ ) {
-      if ( i != curID ) {
-    	dir_to_point = geom[i] - geom[curID];
-    	float angle = cosv2 ( dir_of_gift_wrap, dir_to_point );
-    	if ( angle > max_angle ) {
-    	  max_angle = angle;
-    	  nextID    = i;
-    	}
+    if ( cHull.size() > n ) errorM("Gift wrap didn't close the hull\n");
+
+    const float cx = x[curID], cy = y[curID];
+    nextID = 0;
+    while ( nextID < n && x[nextID] == cx && y[nextID] == cy ) nextID++;
+    if ( nextID == n ) errorM("Need more than 1 distinct point to gift wrap\n");
+
+    for ( size_t step=0; ; step++ ) {
+      if ( step > n ) errorM("Gift wrap didn't find the next point\n");
+      float  left;
+      size_t best = CompGeom::maxOrient2D ( cx, cy, x[nextID], y[nextID], x, y, n, left );
+
+      // Too close to call in floats, any point exactly left of the line will do
+      if ( left <= bound ) {
+	CompGeom::orient2D ( cx, cy, x[nextID], y[nextID], x, y, n, side.data() );
+	for ( best=0; best<n; best++ )
+	  if ( side[best] > -bound &&
+	       CompGeom::orient2DExact ( cx, cy, x[nextID], y[nextID], x[best], y[best] ) > 0 ) break;
+	if ( best == n ) break;
       }
+      nextID = best;
     }
-    dir_of_gift_wrap = geom[nextID] - geom[curID];
     curID = nextID;
   } while ( cHull.front() != curID );
   cHull.push_back ( curID ) ;
@@ -71,33 +99,77 @@ vector< size_t > giftWrap(const CompGeom::Geometry &geom) {
   return std::vector<size_t>(cHull.begin(),cHull.end());
 }
 
+// Same walk on integer points. Seen from a point of the hull every other
+// point is within half a turn, so one pass keeping the point furthest
+// clockwise finds the next point
+vector< size_t > giftWrap(const CompGeom::IntPoints<2> &geom) {
+  if ( geom.size() < 2 ) {
+    errorM("Need more than 2 points to gift wrap\n");
+  }
+  const size_t n = geom.size();
+
+  size_t curID = 0;
+  for ( size_t i=1; i<n; i++ ) if ( geom.x(i) < geom.x(curID) ) curID = i;
+
+  vector < size_t > cHull;
+  do {
+    cHull.push_back ( curID ) ;
+    if ( cHull.size() > n ) errorM("Gift wrap didn't close the hull\n");
+
+    const CompGeom::IVec2 c = geom[curID];
+    size_t nextID = 0;
+    while ( nextID < n && geom.x(nextID) == c.x && geom.y(nextID) == c.y ) nextID++;
+    if ( nextID == n ) errorM("Need more than 1 distinct point to gift wrap\n");
+
+    for ( size_t i=0; i<n; i++ )
+      if ( CompGeom::orient2DExact ( c, geom[nextID], geom[i] ) > 0 ) nextID = i;
+    curID = nextID;
+  } while ( cHull.front() != curID );
+  cHull.push_back ( curID ) ;
+
+  return cHull;
+}
+
+// Sign of the cross product of b-a and c-b, 1 if a,b,c turn anti-clockwise
+template < typename Pts >
+static inline int turn ( const Pts &geom, size_t a, size_t b, size_t c ) {
+  return CompGeom::orient2DExact ( geom[a], geom[b], geom[c] );
+}
+
 // Graham Scan algorithm
 // The last loop is buggy
-vector< size_t > grahamScan(const CompGeom::Geometry &geom_orig) {
-  CompGeom::Geometry geom = geom_orig;
-
+vector< size_t > grahamScan(const CompGeom::Geometry &geom) {
   if ( geom.getDim() != 2 ) {    
     errorM("Can only graham scan 2D geometries\n");
   }  
+  return grahamScan ( CompGeom::Points<2> ( geom ) );
+}
+
+// Only the angles depend on the origin, so the points are centred as
+// the angles are found rather than translating a copy of the geometry
+// The angles are found in Real, double for integer points
+template < typename Real, typename Pts >
+static vector< size_t > grahamScanOf(const Pts &geom) {
   if ( geom.size() < 3 ) {
     errorM("Need more than 2 points to do Graham Scan\n");
   }
+  const size_t n = geom.size();
+  const auto *x = geom.axis(0), *y = geom.axis(1);
 
-  // Find average coordinate, set it to be the new origin
-  CompGeom::Point aveTimesN = std::accumulate ( geom.begin(), geom.end(), CompGeom::Point({0,0}) );
-  geom.translate( { - aveTimesN[0] / float(geom.size()), - aveTimesN[1] / float(geom.size()) } );
+  // Find average coordinate, it is the origin of the angles
+  Real ave[2] = { 0, 0 };
+  for ( size_t i=0; i<n; i++ ) { ave[0] += x[i]; ave[1] += y[i]; }
+  ave[0] /= Real(n);
+  ave[1] /= Real(n);
 
   // Initialise index arrays
-  vector<size_t> idx(geom.size());
+  vector<size_t> idx(n);
   iota ( idx.begin(), idx.end(), 0 );
 
   // Fill angles with the angle each line op
   // makes with the x-axis, from [-pi,pi]
-  vector<float> angles(geom.size());
-  transform ( geom.begin(), geom.end(), angles.begin(), [] ( CompGeom::Point p ) 
-	      {
-		return atan2 ( p[1], p[0] );
-	      } );
+  vector<Real> angles(n);
+  for ( size_t i=0; i<n; i++ ) angles[i] = atan2 ( y[i] - ave[1], x[i] - ave[0] );
 
   // sort indexes based on comparing values in v
   // Shamelessly stolen from Stack Exchange
@@ -110,16 +182,13 @@ vector< size_t > grahamScan(const CompGeom::Geometry &geom_orig) {
   for ( size_t i=2; i<geom.size(); i++ ) {
     h3 = idx[i];
 
-    CompGeom::Point u ( geom[h2] - geom[h1] ), v ( geom[h3] - geom[h2] );
-    float rotation = cross2Product( u, v );
+    int rotation = turn ( geom, h1, h2, h3 );
 
     while ( rotation < 0 && cHull_index.size() >= 2) {
       h2 = h1;      
       h1 = cHull_index.back();
       cHull_index.pop_back();
-      u = geom[h2] - geom[h1];
-      v = geom[h3] - geom[h2];
-      rotation = cross2Product ( u,v );
+      rotation = turn ( geom, h1, h2, h3 );
     }
     
     if ( rotation > 0 ) {
@@ -147,10 +216,9 @@ vector< size_t > grahamScan(const CompGeom::Geometry &geom_orig) {
     h0   = cHull_index[0];
     h1   = cHull_index[1];
     
-    CompGeom::Point u ( geom[hnm1] - geom[hnm2] ), v ( geom[h0] - geom[hnm1]);
-    float rotation;
+    int rotation;
 
-    rotation = cross2Product ( u,v );
+    rotation = turn ( geom, hnm2, hnm1, h0 );
     // cout << u << " " << v << " " << rotation << endl;
     if ( rotation > 0 ) {
       ;;
@@ -161,9 +229,7 @@ vector< size_t > grahamScan(const CompGeom::Geometry &geom_orig) {
       N--;
     }
 
-    u = geom[h1] - geom[h0];
-    v = geom[h0] - geom[cHull_index[N-1]]; // Possible solution to bug
-    rotation = cross2Product ( v,u );
+    rotation = turn ( geom, cHull_index[N-1], h0, h1 ); // Possible solution to bug
     // cout << u << " " << v << " " << rotation << endl;
     if ( rotation > 0 ) {
       ;;
@@ -187,3 +253,11 @@ vector< size_t > grahamScan(const CompGeom::Geometry &geom_orig) {
   return vector<size_t>(cHull_index.begin(),cHull_index.end());
 }
 
+vector< size_t > grahamScan(const CompGeom::Points<2> &geom) {
+  return grahamScanOf < float > ( geom );
+}
+
+vector< size_t > grahamScan(const CompGeom::IntPoints<2> &geom) {
+  return grahamScanOf < double > ( geom );
+}
+
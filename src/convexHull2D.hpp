@@ -2,7 +2,7 @@
  * Name    : convexHull2D.hpp
  * Author  : Kevin Mooney
  * Created : 25/07/16
- * Updated : 
+ * Updated : 17/10/26
  *
  * Description:
  *
@@ -13,11 +13,17 @@
 #pragma once
 
 #include "geometry.hpp"
+#include "intPoints.hpp"
 #include "point.hpp"
+#include "points.hpp"
 
 // Gift wrap algorithm
 std::vector< size_t > giftWrap(const CompGeom::Geometry &geom);
+std::vector< size_t > giftWrap(const CompGeom::Points<2> &geom);
+std::vector< size_t > giftWrap(const CompGeom::IntPoints<2> &geom);
 
 // Graham Scan algorithm
 std::vector< size_t > grahamScan(const CompGeom::Geometry &geom);
+std::vector< size_t > grahamScan(const CompGeom::Points<2> &geom);
+std::vector< size_t > grahamScan(const CompGeom::IntPoints<2> &geom);
 
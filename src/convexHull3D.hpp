@@ -2,66 +2,100 @@
  * Name    : convexHull.hpp
  * Author  : Kevin Mooney
  * Created : 20/07/16
- * Updated : 
+ * Updated : 17/10/26
  *
  * Description:
+ *   Trace of a hull as it is built, every update is
+ *   written to file as one timestep
  *
- * ToDo:
+ * NOTES:
+ *   - Timesteps are streamed to the file as they come,
+ *     nothing is kept in memory
+ *   - The number of timesteps isn't known until the end,
+ *     the header leaves room for it and it is filled in
+ *     when the trace is destroyed
+ *   - Nothing is written by a trace that failed to open
  ******************************************************/
 
+#pragma once
+
+#include <fstream>
+#include <iomanip>
 #include <string>
-#include <vector>
 
-#include "triangle.hpp"
+#include "geometry.hpp"
+#include "points.hpp"
+#include "star.hpp"
 
 namespace CompGeom {
-  class ConvexHull3D {
 
+  // File of a trace, the points first then the timesteps
+  class TraceFile {
   private:
-    std::vector < Triangle > current;
-    std::vector < std::vector < Triangle > > old; 
-    const Geometry geom;
+    std::ofstream  _file;
+    std::streampos _stepsAt;	// Where the number of timesteps goes
+    size_t	   _steps;
 
   public:
-    ConvexHull3D ( const Geometry & geom ) : current{}, old{}, geom{geom} {}
+    // G is a Geometry or Points<3>
+    template < typename G >
+    TraceFile ( const std::string &file_name, const std::string &type, const G &geom )
+      : _file { file_name }, _steps{0}
+    {
+      if ( !_file ) return;
+      _file << "META DATA \n";
+      _file << "TYPE " << type << "\n";
+      _file << "Number of Points " << geom.size() << "\n";
+      _file << "Number of Timesteps ";
+      _stepsAt = _file.tellp();
+      _file << std::setw(20) << std::left << 0 << "\n";
 
-    template < typename inputIt >
-    void update ( const inputIt start, const inputIt end ) {
-      if ( !current.empty() ) old.push_back(current);
-      current.assign(start,end);
+      _file << "\n";
+      for ( size_t i=0; i<geom.size(); i++ ) _file << "POINT " << i << " " << geom[i] << "\n";
     }
 
-    void print ( const std::string &file_name );
-  };
+    ~TraceFile () {
+      if ( !_file ) return;
+      _file.seekp ( _stepsAt );
+      _file << std::setw(20) << std::left << _steps;
+    }
 
+    bool is_open () const { return bool(_file); }
 
-  inline void ConvexHull3D::print ( const std::string & file_name ) {
-    std::ofstream file ( file_name );
+    // Starts the next timestep, returns the stream to write it to
+    std::ostream &step () { _file << "\n\n" << "Timestep " << _steps++ << "\n"; return _file; }
+  };
 
-    file << "META DATA \n";
-    file << "TYPE " << "Convex Hull" << "\n";
-    file << "Number of Points " << geom.size() << "\n";
-    file << "Number of Timesteps " << old.size() << "\n";
+  class ConvexHull3D {
 
-    int c=0;
-    file << "\n";
-    for ( auto i : geom ) file << "POINT " << c++ << " " << i << std::endl;
+  private:
+    TraceFile file;
+
+  public:
+    template < typename G >
+    ConvexHull3D ( const G & geom, const std::string &file_name )
+      : file { file_name, "Convex Hull", geom } {}
 
-    size_t i;
-    for ( i=0; i<old.size(); i++ ) {
-      file << "\n\n";
-      file << "Timestep " << i << "\n";
-      file << "Number of Triangles " << old[i].size() << "\n";
-      file << "START HULL\n";
-      for ( auto tri : old[i] ) 
-	file << tri[0] << " " << tri[1] << " " << tri[2] << "\n";
+    // Writes the triangles in [start,end) as the next timestep
+    template < typename inputIt >
+    void update ( inputIt start, const inputIt end ) {
+      if ( !file.is_open() ) return;
+      std::ostream &out = file.step();
+      out << "Number of Triangles " << std::distance ( start, end ) << "\n";
+      out << "START HULL\n";
+      for ( ; start != end; ++start )
+	out << (*start)[0] << " " << (*start)[1] << " " << (*start)[2] << "\n";
     }
 
-    file << "\n\n";
-    file << "Timestep " << i << "\n";
-    file << "Number of Triangles " << current.size() << "\n";
-    file << "START HULL\n";
-    for ( auto tri : current ) 
-      file << tri[0] << " " << tri[1] << " " << tri[2] << "\n";
-  }
+    // Writes the triangles of a star as the next timestep
+    void update ( const Star &star ) {
+      if ( !file.is_open() ) return;
+      const size_t m = star.size();
+      std::ostream &out = file.step();
+      out << "Number of Triangles " << m << "\n";
+      out << "START HULL\n";
+      for ( size_t i=0; i<m; i++ )
+	out << star.id() << " " << star[i] << " " << star[(i+1)%m] << "\n";
+    }
+  };
 }
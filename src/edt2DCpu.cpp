@@ -0,0 +1,211 @@
+/******************************************************
+ * Name    : edt2DCpu.cpp
+ * Author  : Kevin Mooney
+ * Created : 17/10/26
+ * Updated :
+ *
+ * Description:
+ *   Separable exact Euclidean distance transform, keeping
+ *   track of which site each pixel is closest to
+ *
+ * NOTES:
+ *   - A. Meijster, J. Roerdink and W. Hesselink, "A general
+ *     algorithm for computing distance transforms in linear
+ *     time" (2000)
+ *   - Columns are the 1D pass and rows the envelope pass,
+ *     this way both passes read memory contiguously
+ ******************************************************/
+
+#include <algorithm>
+#include <vector>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define EDT_HAVE_X86
+#include <immintrin.h>
+#endif
+
+#include "edt2DCpu.hpp"
+#include "parallel.hpp"
+#include "pba2D.h"
+
+#define COLBLOCK 32		// Columns given to a single pass 1 task
+#define FAR      (1 << 20)	// Further than any row of the texture
+
+using namespace CompGeom;
+
+static bool hasAVX2 () {
+#ifdef EDT_HAVE_X86
+  return __builtin_cpu_supports ( "avx2" );
+#else
+  return false;
+#endif
+}
+
+// Rounds towards minus infinity, den > 0
+static inline long long floorDiv ( long long num, long long den ) {
+  return num >= 0 ? num / den : -((-num + den - 1) / den);
+}
+
+EDT2DCpu::EDT2DCpu ( int textureSize )
+  : _size   {textureSize}
+  , _nearest(textureSize*textureSize)
+{}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+/////////////////////////////  PASS 1  ///////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+
+// Finds the row of the nearest site in each of the columns [x0,x1)
+// Columns without a site are set to a row outside the texture
+void EDT2DCpu::columnPass ( const short *input, int x0, int x1 ) {
+  const int N = _size;
+  int       below[COLBLOCK];
+
+  // Sweep down, last site at or above each pixel
+  for ( int y = 0; y < N; y++ ) {
+    for ( int x = x0; x < x1; x++ ) {
+      const int id = y*N + x;
+      if      ( input[2*id] != MARKER ) _nearest[id] = y;
+      else if ( y == 0                ) _nearest[id] = -FAR;
+      else                              _nearest[id] = _nearest[id-N];
+    }
+  }
+
+  // Sweep up, keep the closer of the sites above and below
+  std::fill ( below, below + COLBLOCK, FAR );
+  for ( int y = N-1; y >= 0; y-- ) {
+    for ( int x = x0; x < x1; x++ ) {
+      const int id = y*N + x;
+      int      &b  = below[x-x0];
+      if ( input[2*id] != MARKER ) b = y;
+      if ( b - y < y - _nearest[id] ) _nearest[id] = b;
+    }
+  }
+}
+
+// Same as columnPass, 8 columns at a time
+// Each pixel of the input is two shorts, so one 32 bit lane holds one pixel
+#ifdef EDT_HAVE_X86
+__attribute__ ((target ("avx2")))
+void EDT2DCpu::columnPassAVX2 ( const short *input, int x0, int x1 ) {
+  const int     N      = _size;
+  const int     xv     = x0 + 8*((x1-x0)/8);
+  const __m256i low    = _mm256_set1_epi32 ( 0xFFFF );
+  const __m256i marker = _mm256_set1_epi32 ( MARKER & 0xFFFF );
+  int           below[COLBLOCK];
+
+  for ( int y = 0; y < N; y++ ) {
+    const __m256i vy = _mm256_set1_epi32 ( y );
+    for ( int x = x0; x < xv; x += 8 ) {
+      const int     id    = y*N + x;
+      const __m256i pixel = _mm256_loadu_si256 ( (const __m256i *) &input[2*id] );
+      const __m256i empty = _mm256_cmpeq_epi32 ( _mm256_and_si256 ( pixel, low ), marker );
+      const __m256i above = y ? _mm256_loadu_si256 ( (const __m256i *) &_nearest[id-N] )
+	                      : _mm256_set1_epi32  ( -FAR );
+      _mm256_storeu_si256 ( (__m256i *) &_nearest[id], _mm256_blendv_epi8 ( vy, above, empty ) );
+    }
+  }
+
+  std::fill ( below, below + COLBLOCK, FAR );
+  for ( int y = N-1; y >= 0; y-- ) {
+    const __m256i vy = _mm256_set1_epi32 ( y );
+    for ( int x = x0; x < xv; x += 8 ) {
+      const int     id    = y*N + x;
+      const __m256i pixel = _mm256_loadu_si256 ( (const __m256i *) &input[2*id] );
+      const __m256i empty = _mm256_cmpeq_epi32 ( _mm256_and_si256 ( pixel, low ), marker );
+      __m256i       b     = _mm256_loadu_si256 ( (const __m256i *) &below[x-x0] );
+      b                   = _mm256_blendv_epi8 ( vy, b, empty );
+      _mm256_storeu_si256 ( (__m256i *) &below[x-x0], b );
+
+      const __m256i up    = _mm256_loadu_si256 ( (const __m256i *) &_nearest[id] );
+      const __m256i down  = _mm256_cmpgt_epi32 ( _mm256_sub_epi32 ( vy, up ),
+						 _mm256_sub_epi32 ( b , vy ) );
+      _mm256_storeu_si256 ( (__m256i *) &_nearest[id], _mm256_blendv_epi8 ( up, b, down ) );
+    }
+  }
+
+  // Columns left over
+  if ( xv < x1 ) columnPass ( input, xv, x1 );
+}
+#else
+void EDT2DCpu::columnPassAVX2 ( const short *input, int x0, int x1 ) {
+  columnPass ( input, x0, x1 );
+}
+#endif
+
+//////////////////////////////////////////////////////////////////////////////////////////
+/////////////////////////////  PASS 2  ///////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+
+// Lower envelope of f_i(u) = (u-i)^2 + (g(i)-y)^2 along row y, where g(i) is
+// the nearest site in column i. sites and starts are scratch of size N
+void EDT2DCpu::rowPass ( short *output, int y, int *sites, int *starts ) const {
+  const int  N   = _size;
+  const int *g   = &_nearest[y*N];
+  short     *out = &output[2*y*N];
+
+  auto h = [g,y] ( int i ) { long long d = g[i] - y; return d*d; };
+  auto f = [h]   ( long long u, int i ) { return (u-i)*(u-i) + h(i); };
+
+  int q = -1;
+  for ( int u = 0; u < N; u++ ) {
+    if ( g[u] < 0 || g[u] >= N ) continue;
+
+    while ( q >= 0 && f(starts[q],sites[q]) > f(starts[q],u) ) q--;
+
+    if ( q < 0 ) {
+      q         = 0;
+      sites [0] = u;
+      starts[0] = 0;
+    }
+    else {
+      // First column where u is strictly closer than the top of the stack
+      const int       i = sites[q];
+      const long long w = 1 + floorDiv ( (long long) u*u - (long long) i*i + h(u) - h(i), 2*(u-i) );
+      if ( w < N ) {
+	q++;
+	sites [q] = u;
+	starts[q] = w;
+      }
+    }
+  }
+
+  // No sites anywhere in the texture
+  if ( q < 0 ) {
+    std::fill ( out, out + 2*N, short(MARKER) );
+    return;
+  }
+
+  for ( int u = N-1; u >= 0; u-- ) {
+    out[2*u  ] = sites[q];
+    out[2*u+1] = g[sites[q]];
+    if ( u == starts[q] ) q--;
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+/////////////////////////////  VORONOI DIAGRAM  //////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+
+void EDT2DCpu::voronoiDiagram ( const short *input, short *output ) {
+  const int  N       = _size;
+  const int  nBlocks = (N + COLBLOCK - 1) / COLBLOCK;
+  const bool avx2    = hasAVX2();
+
+  parallelFor ( nBlocks, [&] ( size_t b ) {
+      const int x0 = b*COLBLOCK, x1 = std::min ( N, x0+COLBLOCK );
+      if ( avx2 ) columnPassAVX2 ( input, x0, x1 );
+      else        columnPass     ( input, x0, x1 );
+    } );
+
+  // A few chunks of rows per thread, each with its own scratch
+  // The scratch is kept between calls, it only grows with the thread count
+  const size_t nChunks = std::min < size_t > ( N, 4*numThreads() );
+  if ( _scratch.size() < 2*N*nChunks ) _scratch.resize ( 2*N*nChunks );
+  parallelFor ( nChunks, [&] ( size_t c ) {
+      int *sites  = &_scratch[2*N*c  ];
+      int *starts = &_scratch[2*N*c+N];
+      for ( size_t y = c*N/nChunks; y < (c+1)*N/nChunks; y++ )
+	rowPass ( output, y, sites, starts );
+    } );
+}
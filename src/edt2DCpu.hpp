@@ -0,0 +1,48 @@
+/******************************************************
+ * Name    : edt2DCpu.hpp
+ * Author  : Kevin Mooney
+ * Created : 17/10/26
+ * Updated :
+ *
+ * Description:
+ *   Discrete Voronoi diagram from a separable exact
+ *   Euclidean distance transform (Meijster et al.).
+ *   Same input and output layout as pba2DVoronoiDiagram,
+ *   see lib/pba2D.h
+ *
+ * NOTES:
+ *   - Pass 1 finds the nearest site in each column, it
+ *     works on 8 columns at a time with AVX2 when the cpu
+ *     has it and falls back to scalar code otherwise
+ *   - Pass 2 takes the lower envelope of the parabolas
+ *     along each row in exact integer arithmetic
+ *   - Ties between equidistant sites may be broken
+ *     differently to PBA
+ ******************************************************/
+
+#pragma once
+
+#include <vector>
+
+namespace CompGeom {
+
+  class EDT2DCpu {
+  private:
+    int _size;
+    std::vector < int > _nearest; // Row of the nearest site in the same column
+    std::vector < int > _scratch; // Envelope stacks of the row pass
+
+    void columnPass        ( const short *input, int x0, int x1 );
+    void columnPassAVX2    ( const short *input, int x0, int x1 );
+    void rowPass           ( short *output, int y, int *sites, int *starts ) const;
+
+  public:
+    // textureSize is the width (and height) of the texture
+    EDT2DCpu ( int textureSize );
+
+    int size() const { return _size; }
+
+    // Same input and output as pba2DVoronoiDiagram
+    void voronoiDiagram ( const short *input, short *output );
+  };
+}
@@ -0,0 +1,270 @@
+/******************************************************
+ * Name    : exactPredicates.cpp
+ * Author  : Kevin Mooney
+ * Created : 17/10/26
+ * Updated :
+ *
+ * Description:
+ *   The orient2DExact filter, and the exact sums that
+ *   both tests fall back to
+ *
+ * NOTES:
+ *   - An expansion is a list of doubles, smallest first,
+ *     whose exact sum is the value. Its sign is the sign
+ *     of the last, largest, term
+ *   - Every difference of the inputs is kept as a two
+ *     term expansion so no rounding happens anywhere in
+ *     the fallback
+ ******************************************************/
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+// The two sum and two product tricks need every operation rounded on
+// its own, a fused multiply add breaks them
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC optimize ("fp-contract=off")
+#endif
+
+#ifdef __clang__
+#pragma clang fp contract(off)
+#endif
+
+#include "exactPredicates.hpp"
+
+#define SPLITTER   134217729.0		  // 2^27 + 1, splits a double into two 26 bit halves
+#define MAXTERMS   192			  // Largest expansion orient3D builds
+
+#define CCWERRBOUND ( (3.0 + 16.0*EXACT_EPSILON) * EXACT_EPSILON )
+
+using namespace CompGeom;
+
+static thread_local size_t fallbacks = 0;
+
+size_t CompGeom::exactFallbacks () { return fallbacks; }
+
+namespace {
+
+  struct Expansion {
+    double t[MAXTERMS];
+    int    n;
+
+    Expansion () : n{0} {}
+
+    // Only the terms in use are copied, most expansions are a few terms
+    Expansion ( const Expansion &e ) : n{e.n} { std::copy ( e.t, e.t+n, t ); }
+    Expansion &operator= ( const Expansion &e ) {
+      n = e.n;
+      std::copy ( e.t, e.t+n, t );
+      return *this;
+    }
+
+    int sign () const { return n == 0 ? 0 : t[n-1] > 0 ? 1 : -1; }
+  };
+
+  // x + y == a + b exactly, x is the rounded sum
+  inline void twoSum ( double a, double b, double &x, double &y ) {
+    x = a + b;
+    const double bv = x - a;
+    const double av = x - bv;
+    y = (a - av) + (b - bv);
+  }
+
+  // x + y == a - b exactly
+  inline void twoDiff ( double a, double b, double &x, double &y ) {
+    x = a - b;
+    const double bv = a - x;
+    const double av = x + bv;
+    y = (a - av) + (bv - b);
+  }
+
+  // Only valid if |a| >= |b|
+  inline void fastTwoSum ( double a, double b, double &x, double &y ) {
+    x = a + b;
+    y = b - (x - a);
+  }
+
+  inline void split ( double a, double &hi, double &lo ) {
+    const double c = SPLITTER * a;
+    hi = c - (c - a);
+    lo = a - hi;
+  }
+
+  // x + y == a * b exactly
+  inline void twoProduct ( double a, double b, double &x, double &y ) {
+    x = a * b;
+    double ahi, alo, bhi, blo;
+    split ( a, ahi, alo );
+    split ( b, bhi, blo );
+    const double err = ((x - ahi*bhi) - alo*bhi) - ahi*blo;
+    y = alo*blo - err;
+  }
+
+  Expansion difference ( double a, double b ) {
+    double x, y;
+    twoDiff ( a, b, x, y );
+    Expansion e;
+    if ( y != 0 ) e.t[e.n++] = y;
+    if ( x != 0 ) e.t[e.n++] = x;
+    return e;
+  }
+
+  // e + b, Shewchuk's grow_expansion_zeroelim
+  void grow ( Expansion &e, double b ) {
+    double q = b, h;
+    int k = 0;
+    for ( int i=0; i<e.n; i++ ) {
+      twoSum ( q, e.t[i], q, h );
+      if ( h != 0 ) e.t[k++] = h;
+    }
+    if ( q != 0 ) e.t[k++] = q;
+    e.n = k;
+  }
+
+  Expansion operator+ ( Expansion e, const Expansion &f ) {
+    for ( int i=0; i<f.n; i++ ) grow ( e, f.t[i] );
+    return e;
+  }
+
+  Expansion operator- ( Expansion e, const Expansion &f ) {
+    for ( int i=0; i<f.n; i++ ) grow ( e, -f.t[i] );
+    return e;
+  }
+
+  // e * b, Shewchuk's scale_expansion_zeroelim
+  Expansion scale ( const Expansion &e, double b ) {
+    Expansion h;
+    if ( e.n == 0 || b == 0 ) return h;
+
+    double q, hh;
+    twoProduct ( e.t[0], b, q, hh );
+    if ( hh != 0 ) h.t[h.n++] = hh;
+    for ( int i=1; i<e.n; i++ ) {
+      double p1, p0, sum;
+      twoProduct ( e.t[i], b, p1, p0 );
+      twoSum ( q, p0, sum, hh );
+      if ( hh != 0 ) h.t[h.n++] = hh;
+      fastTwoSum ( p1, sum, q, hh );
+      if ( hh != 0 ) h.t[h.n++] = hh;
+    }
+    if ( q != 0 ) h.t[h.n++] = q;
+    return h;
+  }
+
+  Expansion operator* ( const Expansion &e, const Expansion &f ) {
+    Expansion p;
+    for ( int i=0; i<f.n; i++ ) p = p + scale ( e, f.t[i] );
+    return p;
+  }
+
+  inline int sign ( double d ) { return d > 0 ? 1 : d < 0 ? -1 : 0; }
+
+  // Axis perturbed in the row of each rank, -1 for none
+  struct Term { int axis[4]; };
+
+  // The sets of perturbed entries with at most one per row and column,
+  // in increasing order of their mask, see orient3DPerturbed
+  std::vector < Term > perturbedTerms () {
+    std::vector < Term > terms;
+    for ( unsigned m=1; m < 1u << 12; m++ ) {
+      Term     t;
+      unsigned used  = 0;
+      bool     valid = true;
+      for ( int r=0; r<4 && valid; r++ ) {
+	const unsigned bits = ( m >> 3*r ) & 7;
+	t.axis[r] = bits == 0 ? -1 : bits == 1 ? 2 : bits == 2 ? 1 : bits == 4 ? 0 : 3;
+	if ( t.axis[r] == 3 || ( t.axis[r] >= 0 && ( used >> t.axis[r] & 1 ) ) ) valid = false;
+	else if ( t.axis[r] >= 0 ) used |= 1u << t.axis[r];
+      }
+      if ( valid ) terms.push_back ( t );
+    }
+    return terms;
+  }
+}
+
+int CompGeom::orient2DExact ( double ax, double ay, double bx, double by, double cx, double cy ) {
+  // (a-c) x (b-c) has the same sign as (b-a) x (c-a)
+  const double detLeft  = (ax - cx) * (by - cy);
+  const double detRight = (ay - cy) * (bx - cx);
+  const double det      = detLeft - detRight;
+
+  // Terms of opposite signs can't cancel
+  double detSum;
+  if ( detLeft > 0 ) {
+    if ( detRight <= 0 ) return sign ( det );
+    detSum = detLeft + detRight;
+  }
+  else if ( detLeft < 0 ) {
+    if ( detRight >= 0 ) return sign ( det );
+    detSum = -detLeft - detRight;
+  }
+  else return sign ( det );
+
+  const double errBound = CCWERRBOUND * detSum;
+  if ( det >= errBound || -det >= errBound ) return sign ( det );
+
+  fallbacks++;
+  const Expansion acx = difference ( ax, cx ), acy = difference ( ay, cy );
+  const Expansion bcx = difference ( bx, cx ), bcy = difference ( by, cy );
+  return ( acx*bcy - acy*bcx ).sign();
+}
+
+// Coordinate a of the point of rank r is moved by eps^(2^k), k = 3*r + 2 - a.
+// The determinant of the rows (p,1) is then a sum of terms, each a set of
+// perturbed entries, at most one per row and column, times the minor left
+// without their rows and columns. A set with mask m of the k is a multiple of
+// eps^m, so going through m in increasing order goes from the largest term
+// to the smallest and the first minor that isn't 0 gives the sign. Those
+// minors are orient2DExact, a difference of coordinates or 1
+int CompGeom::orient3DPerturbed ( const double p[4][3], const size_t id[4] ) {
+  static const std::vector < Term > terms = perturbedTerms();
+
+  unsigned rank[4];
+  for ( int i=0; i<4; i++ ) {
+    rank[i] = 0;
+    for ( int j=0; j<4; j++ ) {
+      if ( j != i && id[j] == id[i] ) return 0;
+      rank[i] += id[j] < id[i];
+    }
+  }
+
+  for ( const auto &term : terms ) {
+    // Expand along the perturbed rows, each leaves a unit entry
+    int rows[4] = { 0, 1, 2, 3 }, cols[4] = { 0, 1, 2, 3 }, nRows = 4, nCols = 4, s = 1;
+    for ( int i=0; i<4; i++ ) {
+      const int axis = term.axis[rank[i]];
+      if ( axis < 0 ) continue;
+      const int ri = std::find ( rows, rows+nRows, i    ) - rows;
+      const int ci = std::find ( cols, cols+nCols, axis ) - cols;
+      if ( ( ri + ci ) % 2 ) s = -s;
+      std::copy ( rows+ri+1, rows+nRows, rows+ri ); nRows--;
+      std::copy ( cols+ci+1, cols+nCols, cols+ci ); nCols--;
+    }
+
+    // The last column is the 1s
+    const double *a = p[rows[0]], *b = p[rows[1]], *c = p[rows[2]];
+    int minor = 1;
+    if ( nRows == 2 ) minor = sign ( a[cols[0]] - b[cols[0]] );
+    if ( nRows == 3 ) minor = orient2DExact ( a[cols[0]], a[cols[1]], b[cols[0]], b[cols[1]],
+					       c[cols[0]], c[cols[1]] );
+    // orient3DExact has the opposite sign of the determinant
+    if ( minor != 0 ) return -s*minor;
+  }
+  return 0;
+}
+
+// Shewchuk's orient3d(a,b,c,p) again, the opposite sign of ours
+int CompGeom::orient3DExactSums ( const double a[3], const double b[3], const double c[3], const double p[3] ) {
+  fallbacks++;
+  Expansion ad[3], bd[3], cd[3];
+  for ( int i=0; i<3; i++ ) {
+    ad[i] = difference ( a[i], p[i] );
+    bd[i] = difference ( b[i], p[i] );
+    cd[i] = difference ( c[i], p[i] );
+  }
+  const Expansion exact = ad[2] * ( bd[0]*cd[1] - cd[0]*bd[1] )
+                        + bd[2] * ( cd[0]*ad[1] - ad[0]*cd[1] )
+                        + cd[2] * ( ad[0]*bd[1] - bd[0]*ad[1] );
+  return -exact.sign();
+}
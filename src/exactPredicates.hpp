@@ -0,0 +1,139 @@
+/******************************************************
+ * Name    : exactPredicates.hpp
+ * Author  : Kevin Mooney
+ * Created : 17/10/26
+ * Updated :
+ *
+ * Description:
+ *   Orientation tests that always give the right sign,
+ *   however close the points are to collinear or
+ *   coplanar
+ *
+ * NOTES:
+ *   - J. R. Shewchuk, "Adaptive Precision Floating-Point
+ *     Arithmetic and Fast Robust Geometric Predicates"
+ *   - The determinant is found in double precision first
+ *     and only recomputed exactly, as a sum of doubles,
+ *     when it is smaller than its error bound
+ *   - Integer points below 2^INTBITS need no filter, the
+ *     determinants fit in 64 bits in 2D and 128 in 3D
+ *   - The filters are inline as they are called for every
+ *     triangle a point is tested against. A fused multiply
+ *     add only drops a rounding so the bounds still hold,
+ *     the exact sums in exactPredicates.cpp turn them off
+ *   - The perturbed orient3DExact is H. Edelsbrunner and
+ *     E. P. Mucke, "Simulation of Simplicity". It costs
+ *     nothing more unless the points are exactly coplanar
+ ******************************************************/
+
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+
+#include "intPoints.hpp"
+#include "points.hpp"
+
+#define EXACT_EPSILON     1.1102230246251565e-16 // 2^-53, half an ulp of 1
+#define EXACT_O3DERRBOUND ( (7.0 + 56.0*EXACT_EPSILON) * EXACT_EPSILON )
+
+namespace CompGeom {
+
+  // Sign of (b-a) x (c-a), 1 if a,b,c turn anti-clockwise, -1 if they
+  // turn clockwise and 0 if they are collinear
+  int orient2DExact ( double ax, double ay, double bx, double by, double cx, double cy );
+
+  // The sign of orient3DExact with no rounding, for when the filter can't tell
+  int orient3DExactSums ( const double a[3], const double b[3], const double c[3], const double p[3] );
+
+  // Sign of ((b-a) x (c-a)) . (p-a), 1 if p is in front of triangle a,b,c
+  // in the sense of Triangle::isVisible, -1 behind and 0 if coplanar
+  inline int orient3DExact ( const double a[3], const double b[3], const double c[3], const double p[3] ) {
+    // Shewchuk's orient3d(a,b,c,p), the opposite sign of ours
+    const double adx = a[0] - p[0], ady = a[1] - p[1], adz = a[2] - p[2];
+    const double bdx = b[0] - p[0], bdy = b[1] - p[1], bdz = b[2] - p[2];
+    const double cdx = c[0] - p[0], cdy = c[1] - p[1], cdz = c[2] - p[2];
+
+    const double bdxcdy = bdx * cdy, cdxbdy = cdx * bdy;
+    const double cdxady = cdx * ady, adxcdy = adx * cdy;
+    const double adxbdy = adx * bdy, bdxady = bdx * ady;
+
+    const double det = adz * (bdxcdy - cdxbdy) + bdz * (cdxady - adxcdy) + cdz * (adxbdy - bdxady);
+
+    const double permanent = ( std::abs ( bdxcdy ) + std::abs ( cdxbdy ) ) * std::abs ( adz )
+                           + ( std::abs ( cdxady ) + std::abs ( adxcdy ) ) * std::abs ( bdz )
+                           + ( std::abs ( adxbdy ) + std::abs ( bdxady ) ) * std::abs ( cdz );
+    const double errBound = EXACT_O3DERRBOUND * permanent;
+    if ( det >  errBound ) return -1;
+    if ( det < -errBound ) return  1;
+    return orient3DExactSums ( a, b, c, p );
+  }
+
+  inline int orient2DExact ( const Vec2 &a, const Vec2 &b, const Vec2 &c ) {
+    return orient2DExact ( a.x, a.y, b.x, b.y, c.x, c.y );
+  }
+
+  inline int orient3DExact ( const Vec3 &a, const Vec3 &b, const Vec3 &c, const Vec3 &p ) {
+    const double A[3] = { a.x, a.y, a.z }, B[3] = { b.x, b.y, b.z };
+    const double C[3] = { c.x, c.y, c.z }, P[3] = { p.x, p.y, p.z };
+    return orient3DExact ( A, B, C, P );
+  }
+
+  // Integer versions, always exact
+  inline int orient2DExact ( const IVec2 &a, const IVec2 &b, const IVec2 &c ) {
+    const int64_t det = ( int64_t(b.x) - a.x ) * ( int64_t(c.y) - a.y )
+                      - ( int64_t(b.y) - a.y ) * ( int64_t(c.x) - a.x );
+    return ( det > 0 ) - ( det < 0 );
+  }
+
+  inline int orient3DExact ( const IVec3 &a, const IVec3 &b, const IVec3 &c, const IVec3 &p ) {
+    const int64_t ux = int64_t(b.x) - a.x, uy = int64_t(b.y) - a.y, uz = int64_t(b.z) - a.z;
+    const int64_t vx = int64_t(c.x) - a.x, vy = int64_t(c.y) - a.y, vz = int64_t(c.z) - a.z;
+    const int64_t wx = int64_t(p.x) - a.x, wy = int64_t(p.y) - a.y, wz = int64_t(p.z) - a.z;
+#ifdef __SIZEOF_INT128__
+    __extension__ typedef __int128 int128;
+    const int128 det = int128 ( uy*vz - uz*vy ) * wx + int128 ( uz*vx - ux*vz ) * wy
+                     + int128 ( ux*vy - uy*vx ) * wz;
+    return ( det > 0 ) - ( det < 0 );
+#else
+    // Differences below 2^27 are exact doubles
+    const double A[3] = { 0, 0, 0 }, B[3] = { double(ux), double(uy), double(uz) };
+    const double C[3] = { double(vx), double(vy), double(vz) }, P[3] = { double(wx), double(wy), double(wz) };
+    return orient3DExact ( A, B, C, P );
+#endif
+  }
+
+  // Sign of orient3DExact for p[0..3] perturbed by a different infinitesimal
+  // amount for each id, never 0 unless two ids are the same
+  int orient3DPerturbed ( const double p[4][3], const size_t id[4] );
+
+  // orient3DExact with coplanar points decided as if each point had been
+  // moved by an infinitesimal amount depending on its id, see NOTES.
+  // Every predicate on the same ids agrees with one set of points in
+  // general position
+  template < typename V >
+  int orient3DExact ( const V &a, const V &b, const V &c, const V &p,
+		      size_t ia, size_t ib, size_t ic, size_t ip ) {
+    const int s = orient3DExact ( a, b, c, p );
+    if ( s != 0 ) return s;
+    const double P[4][3] = { { double(a[0]), double(a[1]), double(a[2]) },
+			     { double(b[0]), double(b[1]), double(b[2]) },
+			     { double(c[0]), double(c[1]), double(c[2]) },
+			     { double(p[0]), double(p[1]), double(p[2]) } };
+    const size_t id[4] = { ia, ib, ic, ip };
+    return orient3DPerturbed ( P, id );
+  }
+
+  // The three points are collinear if all three projections of them are
+  // Integer coordinates are exact doubles
+  template < typename V >
+  bool collinearExact ( const V &a, const V &b, const V &c ) {
+    return orient2DExact ( a.x, a.y, b.x, b.y, c.x, c.y ) == 0 &&
+           orient2DExact ( a.y, a.z, b.y, b.z, c.y, c.z ) == 0 &&
+           orient2DExact ( a.z, a.x, b.z, b.x, c.z, c.x ) == 0;
+  }
+
+  // Number of orient2DExact and orient3DExact calls that needed exact
+  // arithmetic on this thread
+  size_t exactFallbacks ();
+}
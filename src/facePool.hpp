@@ -0,0 +1,104 @@
+/******************************************************
+ * Name    : facePool.hpp
+ * Author  : Kevin Mooney
+ * Created : 17/10/26
+ * Updated :
+ *
+ * Description:
+ *   Storage for the faces of a 3D hull as it is built,
+ *   a HullMesh with the plane of each slot beside it in
+ *   separate arrays
+ *
+ * NOTES:
+ *   - Faces are compact records in contiguous arrays, a
+ *     removed face's slot goes on the mesh's free list
+ *     and is taken by the next face added. Nothing is
+ *     allocated per face
+ *   - An empty slot's plane is DEADPLANE, which no point
+ *     is in front of, so the sides of every slot can be
+ *     found in one call to planesSide and the gaps are
+ *     never visible
+ *   - reset() keeps the memory, so a pool kept between
+ *     hulls only allocates when a hull is bigger than any
+ *     before it
+ ******************************************************/
+
+#pragma once
+
+#include <cfloat>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "hullMesh.hpp"
+#include "points.hpp"
+#include "predicates.hpp"
+#include "triangle.hpp"
+
+#define DEADPLANE (-FLT_MAX)		// d of an empty slot, its normal is 0
+
+namespace CompGeom {
+
+  class FacePool {
+  private:
+    HullMesh      _mesh;
+    AlignedFloats _nx, _ny, _nz, _d;
+    AlignedFloats _side;
+
+  public:
+    HullMesh       &mesh ()       { return _mesh; }
+    const HullMesh &mesh () const { return _mesh; }
+
+    // Slots, including the empty ones
+    size_t size () const { return _mesh.size(); }
+
+    const float *nx () const { return _nx.data(); }
+    const float *ny () const { return _ny.data(); }
+    const float *nz () const { return _nz.data(); }
+    const float *d  () const { return _d .data(); }
+
+    // Returns the slot of the new face, its edges aren't joined up
+    uint32_t add ( uint32_t id0, uint32_t id1, uint32_t id2, const Points<3> &geom ) {
+      const uint32_t f = _mesh.add ( id0, id1, id2 );
+      if ( f == _nx.size() ) {
+	_nx.push_back ( 0 ); _ny.push_back ( 0 ); _nz.push_back ( 0 ); _d.push_back ( 0 );
+      }
+      const Triangle t { id0, id1, id2, geom };
+      _nx[f] = t.plane()[0];
+      _ny[f] = t.plane()[1];
+      _nz[f] = t.plane()[2];
+      _d [f] = t.plane()[3];
+      return f;
+    }
+
+    void remove ( uint32_t f ) {
+      _mesh.remove ( f );
+      _nx[f] = _ny[f] = _nz[f] = 0;
+      _d [f] = DEADPLANE;
+    }
+
+    // Side of every slot's plane p is on, see planesSide
+    const float *sides ( const Vec3 &p ) {
+      _side.resize ( size() );
+      planesSide ( nx(), ny(), nz(), d(), size(), p.x, p.y, p.z, _side.data() );
+      return _side.data();
+    }
+    const float *side () const { return _side.data(); }
+
+    // Closes the gaps, the planes move with their faces
+    void compact () {
+      const std::vector < uint32_t > to = _mesh.compact();
+      for ( uint32_t f=0; f<to.size(); f++ ) {
+	if ( to[f] == NOEDGE ) continue;
+	_nx[to[f]] = _nx[f]; _ny[to[f]] = _ny[f]; _nz[to[f]] = _nz[f]; _d[to[f]] = _d[f];
+      }
+      _nx.resize ( size() ); _ny.resize ( size() ); _nz.resize ( size() ); _d.resize ( size() );
+    }
+
+    void reset () {
+      _mesh.clear();
+      _nx.clear(); _ny.clear(); _nz.clear(); _d.clear();
+      _side.clear();
+    }
+  };
+}
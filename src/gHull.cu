@@ -26,6 +26,7 @@
 #include "directionEnums.hpp"
 #include "errorMessages.hpp"
 #include "geometry.hpp"
+#include "geometryHelper.hpp"
 #include "gHull.cuh"
 #include "pba2D.h"
 #include "voronoi.hpp"
@@ -33,12 +34,11 @@
 #define XBLOCKSIZE  32
 #define YBLOCKSIZE  32
 
-#define RES         512		// Resolution of digital projection
-
 #define NFACES      6		// Number of faces of a cube...
 #define DIM         3		// Dimensions
 #define EPS         1e-5	// Epsilon
 #define MAXSTARSIZE 10
+#define EMPTYPIXEL  0xFFFFFFFFFFFFFFFFull // Packed pixel no point has reached
 
 // pba parameters, choice of parameters discussed in pba paper
 // These are important, they determine the blocksizes
@@ -102,19 +102,23 @@ public:
 class Face {
   float *data;
   int *pids;
+  unsigned long long *pixels;	// Packed (distance,id) while projecting
   int length;
 
   __host__ __device__ __forceinline__
   int index(const int i, const int j) const {return j + i*length; }
 public:
   __host__ __device__
-  Face() : data{NULL}, pids{NULL}, length{0} {}
+  Face() : data{NULL}, pids{NULL}, pixels{NULL}, length{0} {}
   
   __host__ __device__
-  Face( float *data, int *ids, int length ) : data{data}, pids{ids}, length{length} {} 
+  Face( float *data, int *ids, unsigned long long *pixels, int length )
+    : data{data}, pids{ids}, pixels{pixels}, length{length} {}
 
   __host__ __device__ __forceinline__
-  void set ( float *datas, int *ids, int L ) { data = datas; pids = ids; length = L; }
+  void set ( float *datas, int *ids, unsigned long long *pix, int L ) {
+    data = datas; pids = ids; pixels = pix; length = L;
+  }
   
   __host__ __device__ __forceinline__
   float get_data ( int idx, int idy ) const { return data[index(idx,idy)]; }
@@ -131,6 +135,25 @@ public:
   
   __host__ __device__ __forceinline__
   int get_length() { return length; }
+
+  // The distance is the high word and the point id the low word. Distances
+  // are non-negative so the smallest word is the closest point, and the
+  // lowest id on equal distances
+  __device__ __forceinline__
+  void project ( int idx, int idy, float dist, int id ) {
+    unsigned long long val = ((unsigned long long) __float_as_uint(dist) << 32) | (unsigned int) id;
+    atomicMin ( &pixels[index(idx,idy)], val );
+  }
+
+  // Copies a projected pixel to data and pids
+  __device__ __forceinline__
+  void unpack ( int idx, int idy ) {
+    unsigned long long val = pixels[index(idx,idy)];
+    if ( val != EMPTYPIXEL ) {
+      set_data ( idx, idy, __uint_as_float ( val >> 32 )  );
+      set_id   ( idx, idy, int ( val & 0xFFFFFFFF )       );
+    }
+  }
 };
 
 
@@ -252,16 +275,22 @@ void projectToFace_d ( Face *face, Points *points, float *ex, int dir, int N ) {
     int idj = int(w*(p.data[j]-minw)/((maxw-minw)*(1+EPS)));
     int idk = int(w*(p.data[k]-minh)/((maxh-minh)*(1+EPS)));
 
-    float       cmin_val = face->get_data(idj,idk);
-    float       this_min = fabs(p.data[i]-pos);
-
-    if ( cmin_val > this_min ) {
-      face->set_data  (idj,idk, this_min   );
-      face->set_id    (idj,idk, id         );
-    }
+    // Reading the closest distance then writing it is a race between the
+    // threads that land on the same pixel, a further point could overwrite
+    // a closer one. Both are updated at once with an atomic min instead.
+    face->project ( idj, idk, fabs(p.data[i]-pos), id );
   }
 }
 
+// Moves the projection of each pixel into the data and ids of the face
+__global__
+void unpackFace_d ( Face *face, int res ) {
+  int idx   = blockIdx.x*blockDim.x+threadIdx.x;
+  int idy   = blockIdx.y*blockDim.y+threadIdx.y;
+
+  if ( idx < res && idy < res ) face->unpack ( idx, idy );
+}
+
 // Each thread spawns a projection kernel (dynamic parallelism 
 __global__
 void projectToBox_d ( Face *face_d, Points *points_d, float *extrm_d, int N ) {
@@ -274,19 +303,19 @@ void projectToBox_d ( Face *face_d, Points *points_d, float *extrm_d, int N ) {
 }
 
 __host__ __device__
-inline int shortID ( int i, int j ) {
-  return 2*(i*RES + j );
+inline int shortID ( int i, int j, int res ) {
+  return 2*(i*res + j );
 }
 
 // pba transposes the coordinates, hence idx and idy are swapped at assignment
 __global__
-void fillInput_d(short * input, Face * face ) {
+void fillInput_d(short * input, Face * face, int res ) {
   int idx   = blockIdx.x*blockDim.x+threadIdx.x;
   int idy   = blockIdx.y*blockDim.y+threadIdx.y;
   
-  if ( idx < RES && idy < RES ) {
+  if ( idx < res && idy < res ) {
     if ( face->get_id(idx,idy) != MARKER ) {
-      int index = shortID ( idx, idy );
+      int index = shortID ( idx, idy, res );
       input[index]   = idy;
       input[index+1] = idx;
     }
@@ -295,12 +324,12 @@ void fillInput_d(short * input, Face * face ) {
 
 // Range based loops in CUDA
 __global__
-void countOutEdges_d(int *out_edges_p,short *V) {
+void countOutEdges_d(int *out_edges_p,short *V, int res) {
   int idx   = blockIdx.x*blockDim.x+threadIdx.x;
   int idy   = blockIdx.y*blockDim.y+threadIdx.y;
 
-  if ( idx < RES && idy < RES ) {
-    int index  = idx*RES + idy;
+  if ( idx < res && idy < res ) {
+    int index  = idx*res + idy;
     int sindex = 2*index;
     // int count  = 0;
 
@@ -309,9 +338,9 @@ void countOutEdges_d(int *out_edges_p,short *V) {
       int ni = idx+d[0];
       int nj = idy+d[1];
       
-      int nindex = shortID(ni,nj);
+      int nindex = shortID(ni,nj,res);
       // Check bounds first 
-      if ( !(ni < 0 || nj < 0 || ni >= RES || nj >= RES) 
+      if ( !(ni < 0 || nj < 0 || ni >= res || nj >= res) 
       	   && (V[nindex] != V[sindex] || V[nindex+1] != V[sindex+1]) )
       	{
 	  // count++;
@@ -323,12 +352,12 @@ void countOutEdges_d(int *out_edges_p,short *V) {
 }
 
 __global__
-void constructWorkingSet_d(int *frsts,int*scnds,short *V, Face *face,int *out_edges_offest) {
+void constructWorkingSet_d(int *frsts,int*scnds,short *V, Face *face,int *out_edges_offest, int res) {
   int idx   = blockIdx.x*blockDim.x+threadIdx.x;
   int idy   = blockIdx.y*blockDim.y+threadIdx.y;
 
-  if ( idx < RES && idy < RES ) {
-    int index  = idx*RES + idy;
+  if ( idx < res && idy < res ) {
+    int index  = idx*res + idy;
     int sindex = 2*index;
     int count  = 0;
 
@@ -337,9 +366,9 @@ void constructWorkingSet_d(int *frsts,int*scnds,short *V, Face *face,int *out_ed
       int ni = idx+d[0];
       int nj = idy+d[1];
       
-      int nindex = shortID(ni,nj);
+      int nindex = shortID(ni,nj,res);
       // Check bounds first               
-      if ( !(ni < 0 || nj < 0 || ni >= RES || nj >= RES) 
+      if ( !(ni < 0 || nj < 0 || ni >= res || nj >= res) 
       	   && (V[nindex] != V[sindex] || V[nindex+1] != V[sindex+1]) )
       	{
 	  frsts[out_edges_offest[index]+count] = face->get_id ( V[sindex+1], V[sindex] );   
@@ -366,31 +395,31 @@ struct compareEdges : public thrust::binary_function<edgeTuple,edgeTuple,bool> {
 };
 
 
-void constructVoronois_d( dvec<int> &firsts, dvec<int> &seconds, Face *face ) {
+void constructVoronois_d( dvec<int> &firsts, dvec<int> &seconds, Face *face, int res ) {
 
-  const size_t RSQ = RES*RES;
+  const size_t RSQ = res*res;
 
   dvec<short> input ( 2*RSQ );
   std::vector < dvec<short> > output (3,dvec<short>(2*RSQ));
 
   dim3 dimBlock ( XBLOCKSIZE, YBLOCKSIZE  );
-  dim3 dimGrid  ( (RES/dimBlock.x) + (!(RES%dimBlock.x)?0:1), 
-		  (RES/dimBlock.y) + (!(RES%dimBlock.y)?0:1) );
+  dim3 dimGrid  ( (res/dimBlock.x) + (!(res%dimBlock.x)?0:1), 
+		  (res/dimBlock.y) + (!(res%dimBlock.y)?0:1) );
 
   // Initialise memory for PBA algorithm on device
-  pba2DInitialization(RES);
+  pba2DInitialization(res);
 
   for ( int i=0; i<3; i++ ) {
     short * input_p  = thrust::raw_pointer_cast(&input[0]) ;
     short * output_p = thrust::raw_pointer_cast(&output[i][0]);
 
     thrust::fill(input.begin(),input.end(),MARKER );
-    fillInput_d <<< dimGrid,dimBlock >>> (input_p,face+i );
+    fillInput_d <<< dimGrid,dimBlock >>> (input_p,face+i,res );
     // Don't know what the last three numbers do
     pba2DVoronoiDiagram_d(input_p,output_p,P1B,P2B,P3B); 
 
     // hvec<short> input_h = input, output_h = output[i];
-    // makeVoronoiPBM ( &output_h[0], &input_h[0], RES,RES, 
+    // makeVoronoiPBM ( &output_h[0], &input_h[0], res,res, 
     // 		     "parallel" + std::to_string(i) + ".pbm" );
   }
 
@@ -405,10 +434,10 @@ void constructVoronois_d( dvec<int> &firsts, dvec<int> &seconds, Face *face ) {
     int   * out_edges_p;
 
     out_edges_p = thrust::raw_pointer_cast(&n_out_edges[i*RSQ]);
-    countOutEdges_d<<<dimBlock,dimGrid>>>(out_edges_p,output_p);
+    countOutEdges_d<<<dimBlock,dimGrid>>>(out_edges_p,output_p,res);
 
     out_edges_p = thrust::raw_pointer_cast(&n_out_edges[(i+DIM)*RSQ]);
-    countOutEdges_d<<<dimBlock,dimGrid>>>(out_edges_p,output_p);    
+    countOutEdges_d<<<dimBlock,dimGrid>>>(out_edges_p,output_p,res);    
   }
 
   //Find the offsets for each array plus the output size
@@ -437,8 +466,8 @@ void constructVoronois_d( dvec<int> &firsts, dvec<int> &seconds, Face *face ) {
 
   //////// I just allocated the maximum possible need memory and then reduce it at the end
 
-  // firsts  = dvec<int>(6*4*RES*RES,std::numeric_limits<int>::max());  
-  // seconds = dvec<int>(6*4*RES*RES,std::numeric_limits<int>::max());  
+  // firsts  = dvec<int>(6*4*res*res,std::numeric_limits<int>::max());  
+  // seconds = dvec<int>(6*4*res*res,std::numeric_limits<int>::max());  
   for ( int i=0; i<3; i++ ) {
     short * output_p    = thrust::raw_pointer_cast(&output[i][0]);
     int   * firsts_p;
@@ -453,7 +482,8 @@ void constructVoronois_d( dvec<int> &firsts, dvec<int> &seconds, Face *face ) {
 						 seconds_p,
 						 output_p,
 						 &face[i],
-						 out_edges_p);
+						 out_edges_p,
+						 res);
 
     // All the max faces
     // firsts_p    = thrust::raw_pointer_cast(&firsts[(i+DIM)*4*RSQ]   );
@@ -463,7 +493,8 @@ void constructVoronois_d( dvec<int> &firsts, dvec<int> &seconds, Face *face ) {
 						 seconds_p,
 						 output_p,
 						 &face[i+DIM],
-						 out_edges_p);
+						 out_edges_p,
+						 res);
   }  
   
   //////////////////// SORT AND REMOVE DUPLICATES ////////////////////////////////
@@ -580,7 +611,7 @@ static void constructStars_d ( Stars *stars_d,
 }
 
 
-std::vector < std::vector < size_t > > gHull ( const CompGeom::Geometry &geom ) {
+std::vector < std::vector < size_t > > gHull ( const CompGeom::Geometry &geom, size_t resolution ) {
 
   cudaEvent_t start, stop;
   cudaEventCreate(&start);
@@ -616,30 +647,40 @@ std::vector < std::vector < size_t > > gHull ( const CompGeom::Geometry &geom )
   // dim3 dimGrid ( (N/dimBlock.x) + (!(N%dimBlock.x)?0:1) );
   // printPointsOnCard <<<dimGrid,dimBlock>>> ( points_d, N );
   
+  ////////////////////////////////// FIND EXTREMA /////////////////////////////////
+
+  // Find mins and maxs
+  // Might be faster to do this on the CPU
+  dvec<float> extrm_d(6);
+  findExtremes_d ( extrm_d, px_d, py_d, pz_d );
+
+  if ( resolution == ADAPTIVE_RESOLUTION ) {
+    hvec<float> extrm_h = extrm_d;
+    resolution = adaptiveResolution ( N, std::vector<float> ( extrm_h.begin(), extrm_h.end() ) );
+  }
+  if ( resolution < 64 || (resolution & (resolution-1)) )
+    errorM("gHull needs a power of 2 resolution of at least 64");
+  const int res = resolution;
+
   ////////////////////////////////// SETUP FACES ////////////////////////////////////
 
   //Init faces
   // Numric limits may be different on device, be careful!
-  std::vector < dvec<float> > datas_d ( NFACES,  dvec<float> (RES*RES,std::numeric_limits<float>::max()) );
-  std::vector < dvec<int  > > pids_d  ( NFACES,  dvec<int  > (RES*RES, MARKER) );
+  std::vector < dvec<float> > datas_d ( NFACES,  dvec<float> (res*res,std::numeric_limits<float>::max()) );
+  std::vector < dvec<int  > > pids_d  ( NFACES,  dvec<int  > (res*res, MARKER) );
+  std::vector < dvec<unsigned long long> > pixels_d ( NFACES, dvec<unsigned long long> (res*res, EMPTYPIXEL) );
 
   Face face_h[NFACES];
   Face *face_d;
   for ( size_t i=0; i<NFACES; i++ ) {
     face_h[i].set (thrust::raw_pointer_cast(&datas_d[i][0]),
 		   thrust::raw_pointer_cast(&pids_d[i][0]), 
-		   RES );
+		   thrust::raw_pointer_cast(&pixels_d[i][0]),
+		   res );
   }
   cudaMalloc ( (void **) &face_d, NFACES*sizeof(Face) );
   cudaMemcpy ( face_d, &face_h, NFACES*sizeof(Face), cudaMemcpyHostToDevice );
 
-  ////////////////////////////////// FIND EXTREMA /////////////////////////////////
-
-  // Find mins and maxs
-  // Might be faster to do this on the CPU
-  dvec<float> extrm_d(6);
-  findExtremes_d ( extrm_d, px_d, py_d, pz_d );
-
   ////////////////////////////////// PROJECTION //////////////////////////////////
   
   projectToBox_d<<<1,NFACES>>> ( face_d, 
@@ -647,6 +688,14 @@ std::vector < std::vector < size_t > > gHull ( const CompGeom::Geometry &geom )
 				 thrust::raw_pointer_cast(&extrm_d[0]), 
 				 N );
 
+  // The child projection kernels are finished when the parent is
+  {
+    dim3 dimBlock ( XBLOCKSIZE, YBLOCKSIZE );
+    dim3 dimGrid  ( (res/dimBlock.x) + (!(res%dimBlock.x)?0:1),
+		    (res/dimBlock.y) + (!(res%dimBlock.y)?0:1) );
+    for ( size_t i=0; i<NFACES; i++ ) unpackFace_d <<< dimGrid,dimBlock >>> ( face_d+i, res );
+  }
+
   cudaEventRecord(stop);
   cudaEventSynchronize(stop);
   float milliseconds = 0;
@@ -659,7 +708,7 @@ std::vector < std::vector < size_t > > gHull ( const CompGeom::Geometry &geom )
   // This actually finds all the edges
   dvec< int > firsts;
   dvec< int > seconds;
-  constructVoronois_d ( firsts,seconds,face_d );
+  constructVoronois_d ( firsts,seconds,face_d,res );
 
   cudaEventRecord(stop);
   cudaEventSynchronize(stop);
@@ -719,7 +768,7 @@ std::vector < std::vector < size_t > > gHull ( const CompGeom::Geometry &geom )
   // std::vector < hvec<float> > datas_h(datas_d.begin(),datas_d.end());
   // std::vector < hvec<int  > > pids_h (pids_d.begin(),pids_d.end());
   // for ( auto dat : datas_h ) {
-  //   for ( int i=0; i<RES*RES; i++ ) {
+  //   for ( int i=0; i<res*res; i++ ) {
   //     if (i%10==0 && i!=0) cout << endl;
   //     cout << dat[i] << " " ;
   //   }
@@ -727,7 +776,7 @@ std::vector < std::vector < size_t > > gHull ( const CompGeom::Geometry &geom )
   // }
 
   // for ( auto dat : pids_h ) {
-  //   for ( int i=0; i<RES*RES; i++ ) {
+  //   for ( int i=0; i<res*res; i++ ) {
   //     if (i%10==0 && i!=0) cout << endl;
   //     cout << dat[i] << " " ;
   //   }
@@ -12,5 +12,9 @@
 #pragma once
 
 #include "geometry.hpp"
+#include "geometryHelper.hpp"
 
-std::vector < std::vector < size_t > > gHull ( const CompGeom::Geometry &geom );
+// resolution is the width of the projection faces, ADAPTIVE_RESOLUTION
+// picks one from the number of points and the shape of the bounding box
+std::vector < std::vector < size_t > > gHull ( const CompGeom::Geometry &geom,
+					       size_t resolution = DEFAULT_RESOLUTION );
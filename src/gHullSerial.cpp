@@ -2,15 +2,19 @@
  * Name    : gHullSerial.cpp
  * Author  : Kevin Mooney
  * Created : 16/08/16
- * Updated : 
+ * Updated : 17/10/26
  *
  * Description:
  *
  * NOTES:
+ *   - Star splaying follows Shewchuk, "Star Splaying: An
+ *     Algorithm for Repairing Delaunay Triangulations
+ *     and Convex Hulls"
  ******************************************************/
 
 #include <algorithm>
 #include <chrono>
+#include <cstdint>
 #include <limits>
 #include <list>
 #include <set>
@@ -19,20 +23,36 @@
 
 #include "boundingBox.hpp"
 #include "convexHull3D.hpp"
+#include "edt2DCpu.hpp"		// Exact distance transform on the cpu
+#include "exactPredicates.hpp"
 #include "geometry.hpp"
 #include "geometryHelper.hpp"
+#include "gHullSerial.hpp"
+#include "hullWorkspace.hpp"
+#include "intPoints.hpp"
 #include "orderedEdge.hpp"
+#include "parallel.hpp"
+#include "points.hpp"
 #include "unorderedEdge.hpp"
 #include "pba2D.h"		// Parallel Banding Algorithm
+#include "pba2DCpu.hpp"		// Parallel Banding Algorithm on the cpu
+#include "radixSort.hpp"
 #include "triangle.hpp"
 #include "voronoi.hpp"
 #include "workingSet.hpp"
 #include "star.hpp"
 #include "starHull.hpp"
+#include "starSet.hpp"
+#include "threadPool.hpp"
 
 #include "removeInsert.hpp"
 
 #define EPS	1e-5		// Epsilon
+#define PROJBLOCK  65536	// Fewest points given to one projection task
+#define ROWBLOCK   16384	// Fewest Voronoi pixels given to one dual edge task
+#define SPLAYLIMIT 64		// Star changes per point before splaying gives up
+#define STARTASKS  8		// Star construction tasks per thread
+#define PLANEBOUND 1.1368683772161603e-13 // 1024 * 2^-53, error of a hull plane per M^3
 
 // pba parameters, choice of parameters discussed in pba paper
 // These are important, they determine the blocksizes
@@ -40,8 +60,8 @@
 #define P2B	16		// Phase 2 band
 #define P3B	16		// Phase 3 band
 
-#define BOXSIZE 512
 #define DIM     3
+#define MAXRES  16384		// Largest power of 2 pixel coordinates fit in a short
 
 // I should reconsider using two namespaces
 using namespace std;
@@ -51,50 +71,129 @@ using namespace CompGeom;
 /////////////////////////////  GHULL SERIAL  /////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////////////////////
 
-// Maybe a little bit excesive on the local variables
-void projectToTile (CompGeom::Tile& T, const CompGeom::Geometry & geom, 
-		    vector<float> ex, const Direction::Dir dir ) 
-{
-  const size_t w   = T.nCols();
-  const size_t h   = T.nRows();
-  const size_t i   = dir  %DIM;
-  const size_t j   = (i+1)%DIM;
-  const size_t k   = (i+2)%DIM;
-  const float minw = ex[j];
-  const float minh = ex[k];
-  const float maxw = ex[j+DIM];
-  const float maxh = ex[k+DIM];
-
-
-  // int watchj=-1, watchk=-1;
-  for ( size_t p_i = 0; p_i<geom.size(); p_i++ ) {
-    const auto &p = geom[p_i];
-    int	idj = int(w*(p[j]-minw)/((maxw-minw)*(1+EPS)));
-    int	idk = int(h*(p[k]-minh)/((maxh-minh)*(1+EPS)));    
-
-    float	cmin_val = T.get(idj,idk);
-    float	this_min = fabs(p[i]-ex[dir]);
-    if ( cmin_val > this_min ) {
-      // if ( p_i == 101 || ( watchj == idj && watchk == idk ) ) {
-      // 	cout << dir << " " << p_i << " " << idj << " " << idk <<  endl;
-      // 	watchj = idj; watchk = idk;
-      // }
-      T.set  (idj,idk, this_min   );
-      T.setID(idj,idk, p_i        );
-    }
-  }
+// The face of each axis a point with these depths goes on, the
+// nearer one unless only one is allocated
+static Direction::Dir frontFace ( const BoundingBox &B, size_t i, const float depth[2*DIM] ) {
+  const Direction::Dir near = Direction::Dir(i), far = Direction::Dir(i+DIM);
+  return B.hasFace ( near ) && ( !B.hasFace ( far ) || depth[near] <= depth[far] ) ? near : far;
 }
 
 // Step 1
 // Divide the box into bricks containing chunks of the data. 
 // Project the points onto tiles on the faces
 // deciding conflicts by choosing the closer point
-void projectToBox ( CompGeom::BoundingBox &B, const CompGeom::Geometry &geom ) {
-  vector < float > extremes = findExtremes2 ( geom );
+// All six tiles are filled in a single pass over the points, opposite
+// faces share the same pixel and only differ in the depth.
+// A point only goes onto the nearer face of each axis, otherwise where no
+// point in front reached a pixel near the silhouette it holds a point on
+// the far side, and the dual edges join points across the hull
+// Blocks of points are projected on separate threads, conflicts are
+// decided with an atomic min on the tiles' packed pixels so the result
+// doesn't depend on the order the points are visited.
+// cell ( p, id, depth ) gives the pixel of point p along each axis and its
+// distance from the near face and then the far face of each axis
+template < typename Cell >
+static void projectPoints ( HullWorkspace &ws, size_t n, Cell cell )
+{
+  BoundingBox &B = ws.box();
+  const size_t w = B.length();
+  if ( n >= Tile::noID() ) errorM("Tiles hold 32 bit point ids");
+
+  const size_t nBlocks = std::max < size_t > ( 1, std::min ( n / PROJBLOCK, 4*numThreads() ) );
+  parallelFor ( nBlocks, [&] ( size_t b ) {
+      const size_t first = b*n/nBlocks, last = (b+1)*n/nBlocks;
+
+      for ( size_t p_i = first; p_i<last; p_i++ ) {
+	int   id[DIM];
+	float depth[2*DIM];
+	cell ( p_i, id, depth );
+
+	for ( size_t i=0; i<DIM; i++ ) {
+	  const Direction::Dir face  = frontFace ( B, i, depth );
+	  const uint32_t       pixel = id[(i+1)%DIM]*w + id[(i+2)%DIM];
+
+	  if ( B.hasFace ( face ) && B[face].keepMin ( pixel, Tile::pack ( depth[face], p_i ) ) )
+	    ws.touch ( face, pixel );
+	}
+      }
+    } );
+}
+
+// The cell given to projectPoints for float points
+class FloatCell {
+private:
+  const Points<3>	 &_geom;
+  const vector < float > &_ex;
+  float			  _scale[DIM];	// Pixels per unit length, flat axes all map to pixel 0
+
+public:
+  FloatCell ( const HullWorkspace &ws, const Points<3> &geom, const vector < float > &ex )
+    : _geom(geom), _ex(ex) {
+    for ( size_t a=0; a<DIM; a++ ) {
+      const float extent = ex[a+DIM] - ex[a];
+      _scale[a] = extent > 0 ? ws.box().length() / (extent*(1+EPS)) : 0;
+    }
+  }
+
+  void operator() ( size_t p, int id[DIM], float depth[2*DIM] ) const {
+    for ( size_t a=0; a<DIM; a++ ) {
+      const float x = _geom.coord ( p, a );
+      id   [a]     = int((x-_ex[a])*_scale[a]);
+      depth[a]     = x - _ex[a];
+      depth[a+DIM] = _ex[a+DIM] - x;
+    }
+  }
+};
+
+// Integer coordinates are binned exactly, pixel w*(x-min)/(max-min+1)
+// rounded down. Depths are exact below 2^24
+class IntCell {
+private:
+  const IntPoints<3>	   &_geom;
+  const vector < int32_t > &_ex;
+  int64_t		    _w;
+  int64_t		    _extent[DIM];
+
+public:
+  IntCell ( const HullWorkspace &ws, const IntPoints<3> &geom, const vector < int32_t > &ex )
+    : _geom(geom), _ex(ex), _w(ws.box().length()) {
+    for ( size_t a=0; a<DIM; a++ ) _extent[a] = int64_t(ex[a+DIM]) - ex[a] + 1;
+  }
+
+  void operator() ( size_t p, int id[DIM], float depth[2*DIM] ) const {
+    for ( size_t a=0; a<DIM; a++ ) {
+      const int64_t x = _geom.coord ( p, a );
+      id   [a]     = int ( (x-_ex[a])*_w / _extent[a] );
+      depth[a]     = float ( x - _ex[a] );
+      depth[a+DIM] = float ( _ex[a+DIM] - x );
+    }
+  }
+};
+
+static FloatCell boxCell ( const HullWorkspace &ws, const Points<3> &geom, const vector < float > &ex ) {
+  return FloatCell ( ws, geom, ex );
+}
+
+static IntCell boxCell ( const HullWorkspace &ws, const IntPoints<3> &geom, const vector < int32_t > &ex ) {
+  return IntCell ( ws, geom, ex );
+}
+
+void projectToBox ( HullWorkspace &ws, const Points<3> &geom,
+		    const vector < float > &ex )
+{
+  projectPoints ( ws, geom.size(), boxCell ( ws, geom, ex ) );
+}
 
-  for ( auto dir : Direction::allDirections() ) { 
-    projectToTile ( B[dir], geom, extremes, dir );
-  }  
+void projectToBox ( HullWorkspace &ws, const IntPoints<3> &geom,
+		    const vector < int32_t > &ex )
+{
+  projectPoints ( ws, geom.size(), boxCell ( ws, geom, ex ) );
+}
+
+void projectToBox ( HullWorkspace &ws, const CompGeom::Geometry &geom,
+		    const vector < float > &ex )
+{
+  projectToBox ( ws, Points<3> ( geom ), ex );
 }
 
 //////////////////////// Construct Voronois ////////////////////////////////
@@ -106,26 +205,44 @@ inline size_t shortID ( int i, int j , int w) {
 }
 
 
-// Converts our the tile of projections into pairs of short indexes
-void fillVoronoiInput ( short * input, const CompGeom::Tile &T ) {
-  size_t	w = T.nCols();
-  size_t	h = T.nRows();
+// Marks the pixels points were projected onto as sites of the Voronoi input
+// Pixel (idj,idk) of a tile is site (idk,idj), as pba transposes
+void fillVoronoiInput ( Voronoi &input, const HullWorkspace &ws, Direction::Dir dir ) {
+  const size_t    w       = input.length();
+  const uint32_t *touched = ws.touched ( dir );
 
-  // int count = 0;
-  std::fill ( input, input + 2*w*h, MARKER );
-  for ( size_t idj = 0; idj < w; idj++ ) {
-    for ( size_t idk = 0; idk < h; idk++ ) {
-      int index = shortID(idj,idk,w);    
-      if ( T.get(idj,idk) != numeric_limits<float>::max() ) {
-	input[index]	  = idk;
-	input[index+1]	  = idj;
-	// count++;
-      }
-    }
+  for ( size_t t=0; t<ws.nTouched ( dir ); t++ ) {
+    const size_t idj = touched[t] / w, idk = touched[t] % w;
+    input.set ( idj, idk, idk, idj );
   }
-  // cout << count << endl;
 }
 
+// Sets the sites of fillVoronoiInput back to MARKER
+void clearVoronoiInput ( Voronoi &input, const HullWorkspace &ws, Direction::Dir dir ) {
+  const size_t    w       = input.length();
+  const uint32_t *touched = ws.touched ( dir );
+
+  for ( size_t t=0; t<ws.nTouched ( dir ); t++ )
+    input.set ( touched[t] / w, touched[t] % w, MARKER, MARKER );
+}
+
+// Keeps the sites of one face in the Voronoi input while it is alive,
+// so the input is all MARKER again even if an engine throws
+class VoronoiInputGuard {
+private:
+  Voronoi		&_input;
+  const HullWorkspace	&_ws;
+  Direction::Dir	 _dir;
+
+public:
+  VoronoiInputGuard ( Voronoi &input, const HullWorkspace &ws, Direction::Dir dir ) :
+    _input ( input ), _ws ( ws ), _dir ( dir ) { fillVoronoiInput ( _input, _ws, _dir ); }
+  ~VoronoiInputGuard () { clearVoronoiInput ( _input, _ws, _dir ); }
+
+  VoronoiInputGuard ( const VoronoiInputGuard & ) = delete;
+  VoronoiInputGuard &operator= ( const VoronoiInputGuard & ) = delete;
+};
+
 // Prints the array of pairs of short indexes
 void  printDiagram ( short * input, size_t w , size_t h) {
   for ( size_t l=0; l<h; l++ ) {
@@ -141,263 +258,589 @@ void  printDiagram ( short * input, size_t w , size_t h) {
 
 
 // This function constructs Voronois on the boxes projections
-void constructVoronois ( CompGeom::BoundingBox & B, vector < Voronoi > &VD) {
+// The diagrams are written into the workspace, faces no point reached
+// are skipped
+void constructVoronois ( HullWorkspace &ws ) {
   using namespace Direction;
 
-  size_t	w = B.width();
-  size_t	h = B.height();
-  
-  // Initialise the memory to be passed to pba
-  vector < short > input ( 2*w*h );
-  vector < short > output ( 2*w*h );
-
-  // Allocates memory for the pba library
-  // I'm unsure what the parameter is that we are passing
-  // But in the example main, this is what is passed for
-  // an input array of size 2*w*w as we have here.
-  pba2DInitialization(w);
-
-  // Voronoi is the same on opposite sides
-  // So it is only calculated on the bottom 4 tiles
-  for ( auto dir : { LEFT, BACK, DOWN } ) {
-    // Calculate Voronoi diagram on min tile
-    fillVoronoiInput   (&input[0],B[dir]                );
-    pba2DVoronoiDiagram(&input[0],&output[0],P1B,P2B,P3B);
-
-    // Print Voronoi to file
-    // string filename  = "images/voronoi" + to_string(dir) + ".pbm";
-    // makeVoronoiPBM(output,input,w,h,filename);
-
-    auto & V = VD[dir];
-    for ( size_t i   = 0; i<h; i++ ) {
-      for ( size_t j = 0; j<w; j++ ) {
-	size_t	index = shortID(i,j,w);
-	copy_n ( &output[index], 2, V[i][j].begin() );
-      }
+  const VoronoiEngine engine = ws.engine();
+  Voronoi            &input  = ws.input();
+
+#ifdef PBA_CPU_ONLY
+  if ( engine == PBA_GPU ) errorM("Compiled with PBA_CPU_ONLY, the GPU Voronoi engine is unavailable");
+#endif
+
+  for ( auto dir : allDirections() ) {
+    if ( !ws.box().hasFace ( dir ) || ws.nTouched ( dir ) == 0 ) continue;
+    short *output = ws.voronois()[dir].data();
+
+    VoronoiInputGuard sites ( input, ws, dir );
+#ifndef PBA_CPU_ONLY
+    if ( engine == PBA_GPU ) 
+      pba2DVoronoiDiagram(input.data(),output,P1B,P2B,P3B);
+#endif
+    if ( engine == PBA_CPU )
+      ws.pba().voronoiDiagram(input.data(),output,P1B,P2B,P3B);
+    if ( engine == EDT_CPU )
+      ws.edt().voronoiDiagram(input.data(),output);
+  }
+}
+
+// Direction of the nearest neighbours
+static const int NEIGHBOURS[4][2] = {{-1,0},{0 ,-1},{0 ,1},{1 ,0}};
+
+// Number of dual edges starting in row i of a Voronoi diagram
+// Same as countOutEdges_d in gHull.cu
+static size_t countRowEdges ( const Voronoi &V, int i ) {
+  const int L     = V.length();
+  size_t    count = 0;
+
+  for ( int j=0; j<L; j++ ) {
+    const Short2 site = V(i,j);
+    for ( auto d : NEIGHBOURS ) {
+      int ni = i+d[0];
+      int nj = j+d[1];
+
+      // Check bounds first
+      if ( !(ni < 0 || nj < 0 || ni >= L || nj >= L) && V(ni,nj) != site ) count++;
     }
   }
+  return count;
+}
 
-  // Free all memory
-  pba2DDeinitialization();
-}
-
-// Finds the dual of the Voronoi diagram
-void findDualEdges ( vector<OrderedEdge> &W, const Tile &T, const Voronoi & V ) {
-  int L = T.length();
-
-  for ( int i=0; i<L; i++ ) {
-    for ( int j=0; j<L; j++ ) {
-
-      // Direction of the nearest neighbours
-      const vector<vector<int>> dir =  {{-1,0},{0 ,-1},{0 ,1},{1 ,0}};      
-      for ( auto d : dir ) {
-	int ni = i+d[0];
-	int nj = j+d[1];
-
-	// Check bounds first
-	if ( !(ni < 0 || nj < 0 || ni >= L || nj >= L) 
-	     && V[ni][nj] != V[i][j] ) 
-	  {
-	    // pba2D has indexing (j,i) so the ids are swapped around
-	    size_t id0 = T.getID ( V[i ][j ][1], V[i ][j ][0] );
-	    size_t id1 = T.getID ( V[ni][nj][1], V[ni][nj][0] );
-	    // if ( id0 == 101 ) cout << id0 << " " << id1 << endl;
-	    // if ( id1 == 101 ) cout << id0 << " " << id1 << endl;
-	    W.push_back(OrderedEdge ( id0, id1 ));
-	  }
+// Finds the dual of row i of the Voronoi diagram
+// Edges are written from keys as (id0 << b) | id1
+static void findDualEdges ( uint64_t *keys, const Tile &T, const Voronoi &V, int i, unsigned b ) {
+  const int L = V.length();
+
+  for ( int j=0; j<L; j++ ) {
+    const Short2 site = V(i,j);
+    for ( auto d : NEIGHBOURS ) {
+      int ni = i+d[0];
+      int nj = j+d[1];
+
+      // Check bounds first
+      if ( !(ni < 0 || nj < 0 || ni >= L || nj >= L) && V(ni,nj) != site ) {
+	// pba2D has indexing (j,i) so the ids are swapped around
+	const uint64_t id0 = T.getID ( site.y     , site.x      );
+	const uint64_t id1 = T.getID ( V(ni,nj).y, V(ni,nj).x );
+	*keys++ = (id0 << b) | id1;
       }
     }
   }
 }
 
-void constructWorkingSets ( vector<WorkingSet> & W, 
-			    const BoundingBox & B, 
-			    const vector < Voronoi > & V ) 
+// Bits needed for the ids of n points
+static unsigned idBits ( size_t n ) {
+  unsigned b = 1;
+  while ( b < 32 && (size_t(1) << b) < n ) b++;
+  return b;
+}
+
+// Works like the cuda version, the edges of every row of every face are
+// counted, scanned into offsets then written concurrently. The packed
+// edges are then radix sorted and repeats removed.
+void constructWorkingSets ( WorkingSets & W, HullWorkspace & ws, size_t nPoints )
 {
-  vector < OrderedEdge > Vedges;
-  
+  const BoundingBox        &B      = ws.box();
+  const vector < Voronoi > &V      = ws.voronois();
+  const size_t              L      = B.length();
+  const unsigned            b      = idBits ( nPoints );
+  vector < size_t >        &offset = ws.rowEdges();
+  vector < uint64_t >      &keys   = ws.keys();
+
+  const size_t rows = std::max < size_t > ( 1, ROWBLOCK / L );
+  offset.assign ( 2*DIM*L + 1, 0 );
+  parallelFor ( 2*DIM*L, [&] ( size_t r ) {
+      const Direction::Dir dir = Direction::Dir(r/L);
+      if ( B.hasFace ( dir ) && ws.nTouched ( dir ) > 0 )
+	offset[r+1] = countRowEdges ( V[dir], r%L );
+    }, rows );
+  for ( size_t r=0; r<2*DIM*L; r++ ) offset[r+1] += offset[r];
+
   // Find all the edges from the Voronoi diagrams 
-  for ( auto dir : Direction::allDirections() ) {
-    findDualEdges ( Vedges, B[dir], V[dir%3] );
-  }
+  keys.resize ( offset[2*DIM*L] );
+  parallelFor ( 2*DIM*L, [&] ( size_t r ) {
+      const Direction::Dir dir = Direction::Dir(r/L);
+      if ( offset[r+1] > offset[r] ) findDualEdges ( &keys[offset[r]], B[dir], V[dir], r%L, b );
+    }, rows );
 
   // Sort and remove duplicates
-  sort(Vedges.begin(),Vedges.end());
-  auto it = unique(Vedges.begin(),Vedges.end());
-  Vedges.resize ( distance ( Vedges.begin(), it ), OrderedEdge(-1,-1) );
-
-  // cout << "====== SERIAL ======\n";
-  // cout << "Serial Size : " << Vedges.size() << endl;
-  // for ( auto edge : Vedges ) {
-  //   cout << edge.first << " " << edge.second << endl;
-  // }
-
-  // Construct the vector of Working Sets
-  size_t curr_index = 0;
-  WorkingSet curr;
-  for ( auto ei : Vedges ) {
-    if ( ei.first != curr_index ) {
-      if ( !curr.empty() ) W.push_back(curr);
-      curr.resize(0, OrderedEdge(-1,-1));
-      curr_index = ei.first;
-    }
-    curr.push_back(ei);
-  }
+  radixSort    ( keys, ws.keyScratch(), ws.sortCounts(), 2*b );
+  uniqueSorted ( keys, ws.keyScratch(), ws.sortCounts()      );
+
+  // Construct the Working Sets, like reduce_by_key in gHull.cu
+  // Each block counts the stars starting in it, a scan of the counts
+  // gives where its stars go
+  const uint64_t  mask   = (uint64_t(1) << b) - 1;
+  const size_t    n      = keys.size();
+  const size_t    nb     = radixBlocks ( n );
+  vector<size_t> &counts = ws.sortCounts();
+  auto isHead = [&] ( size_t i ) { return i == 0 || (keys[i] >> b) != (keys[i-1] >> b); };
+
+  counts.assign ( nb+1, 0 );
+  parallelFor ( nb, [&] ( size_t k ) {
+      for ( size_t i = k*n/nb; i < (k+1)*n/nb; i++ ) counts[k+1] += isHead(i);
+    } );
+  for ( size_t k=0; k<nb; k++ ) counts[k+1] += counts[k];
+
+  W.ids       .resize ( counts[nb]   );
+  W.offsets   .resize ( counts[nb]+1 );
+  W.neighbours.resize ( n            );
+  W.offsets[counts[nb]] = n;
+  parallelFor ( nb, [&] ( size_t k ) {
+      size_t star = counts[k];
+      for ( size_t i = k*n/nb; i < (k+1)*n/nb; i++ ) {
+	if ( isHead(i) ) {
+	  W.ids    [star] = keys[i] >> b;
+	  W.offsets[star] = i;
+	  star++;
+	}
+	W.neighbours[i] = keys[i] & mask;
+      }
+    } );
 }
 
-// Untested
-void delete_visible_backwards ( list<Triangle> &Star, const CompGeom::Point &p ) {
-  auto it = Star.end();
-  --it;
-  while ( it->isVisible(p) ) {
-    --it;
-  }
-  ++it;
-  Star.erase(it,Star.end());
+//////////////////////// Star Splaying ////////////////////////////////
+
+// Checks if point p is in front of triangle (a,b,c)
+// Same test as Triangle::isVisible, but exact so stars never disagree
+// about a point that is nearly coplanar with one of their triangles.
+// Coplanar points are perturbed by their ids, so splaying sees the points
+// in general position, repeated points included, and always settles
+template < typename Pts >
+static inline bool isVisible ( const Pts &pts, size_t a, size_t b, size_t c, size_t p ) {
+  return orient3DExact ( pts[a], pts[b], pts[c], pts[p], a, b, c, p ) > 0;
 }
 
-// Untested
-void delete_visible_forwards ( list<Triangle> &Star, const CompGeom::Point &p) {
-  auto it = Star.begin();
-  while ( it->isVisible(p) ) {
-    it++;
-  }
-  Star.erase(Star.begin(),it);
-}
-
-// Rethink checking the start is at the end, initial if statement
-template <typename iter>
-iter findNextVisible    (iter start,iter end,const size_t &star_id, const size_t &id,const Geometry & geom) {
-  iter second = start;
-  advance(second,1);
-  const Point &p = geom[id];
-  for ( ; start != end && second != end; ++start, ++second ) {
-    Triangle tri ( star_id, *start, *second, geom );
-    if ( tri.isVisible(p) )
-      return start;
-  }
-  return end;
-}
-
-// Rethink checking the start is at the end, initial if statement
-template <typename iter>
-iter findNextNotVisible    (iter start,iter end,const size_t &star_id, const size_t &id,const Geometry & geom) {
-  iter second = start;
-  advance(second,1);
-  const Point &p = geom[id];
-  for ( ; start != end && second != end ; ++start, ++second ) {
-    Triangle tri ( star_id, *start, *second, geom );
-    if ( !tri.isVisible(p) )
-      return start;
+enum StarChange { HIDDEN, ADDED, KILLED };
+
+// Inserts point pid into a star, the triangles pid can see are replaced
+// by two triangles joining it to the star. If pid sees every triangle the
+// star's point is inside the hull, the star dies keeping its edges and pid
+// as the points that enclose it.
+template < typename Pts >
+static StarChange insertIntoStar ( Star star, uint32_t pid, const Pts &pts ) {
+  const size_t m = star.size();
+  if ( star.id() == pid ) return HIDDEN;
+  for ( auto e : star ) if ( e == pid ) return HIDDEN;
+
+  // Triangle i is (id, star[i], star[i+1])
+  static thread_local vector < char > visible;
+  visible.resize ( m );
+  size_t nVisible = 0;
+  for ( size_t i=0; i<m; i++ )
+    nVisible += visible[i] = isVisible ( pts, star.id(), star[i], star[(i+1)%m], pid );
+
+  if ( nVisible == 0 ) return HIDDEN;
+  if ( nVisible == m ) {
+    star.kill();
+    star.push_back ( pid );
+    return KILLED;
   }
-  return end;
+
+  // The visible triangles are a chain first..first+length-1, the edges
+  // strictly inside it are erased, possibly wrapping round the ring, and
+  // pid goes after star[first]
+  size_t first = 0, length = 1;
+  while ( !visible[first] || visible[(first+m-1)%m] ) first++;
+  while ( visible[(first+length)%m] ) length++;
+
+  const size_t from   = (first+1)%m, count = length-1;
+  size_t       before = 0;		// Edges erased from in front of star[first]
+  if      ( from + count > m ) before = from + count - m;
+  else if ( from <= first    ) before = count;
+
+  star.erase  ( from, count );
+  star.insert ( first - before + 1, pid );
+  return ADDED;
 }
 
-Star constructStar_h ( const WorkingSet & W, const CompGeom::Geometry &geom ) {
+// Builds the star of W.id in arena from its working set, one point at a time
+// Each step is written to trace unless it is NULL
+template < typename Pts >
+static Star constructStar_h ( const WorkingSetSpan & W, const Pts &pts, StarArena &arena,
+			      ConvexHull3D *trace = NULL )
+{
   if ( W.size() < 3 ) errorM("Working Set does not have enough edges");
 
-  Star tstar(W[0].first);
-  Triangle t0( tstar.id , W[0].second, W[1].second, geom );
+  Star tstar = arena.add ( W.id );
+  if ( isVisible ( pts, W.id, W[0], W[1], W[2] ) ) tstar.assign ( { W[1], W[0], W[2] } );
+  else                                            tstar.assign ( { W[0], W[1], W[2] } );
+  if ( trace ) trace->update ( tstar );
 
-  auto tid = W[2].second;	// temp id
-  if ( t0.isVisible(geom[tid]) ) {
-    t0.invert();
+  for ( auto it = W.begin()+3; it!=W.end() && tstar.alive(); ++it ) {
+    insertIntoStar ( tstar, *it, pts );
+    if ( trace ) trace->update ( tstar );
   }
+  return tstar;
+}
 
-  tstar.insert( tstar.end(), t0[1] );
-  tstar.insert( tstar.end(), t0[2] );
-  tstar.insert( tstar.end(), tid    );
-
-  ConvexHull3D ch(geom);
-
-  auto it = W.begin();
-  for ( advance(it,3); it!=W.end(); it++ ) {
-    const auto &pid = it->second; // point id
-    const auto &p  = geom[pid];
-    
-    // If the edge from the back to the front of the list is visible
-    Triangle tri(tstar.id,tstar.back(),tstar.front(),geom);
-    if ( tri.isVisible(p) ) {      
-      Star::iterator to   = findNextNotVisible (tstar.begin(), tstar.end(), tstar.id, pid, geom);
-      to = tstar.erase(tstar.begin(),to);
-      if ( tstar.empty() ) {	// If all edges are visible then the star is dead
-	break;
-      }
+// Compiled with TRACE_HULLS the steps are written to initialStar.txt
+// Callers convert a Geometry to Points<3> once, not for every star
+Star constructStar_h ( const WorkingSetSpan & W, const Points<3> &pts, StarArena &arena ) {
+#ifdef TRACE_HULLS
+  ConvexHull3D trace ( pts, "initialStar.txt" );
+  return constructStar_h < Points<3> > ( W, pts, arena, &trace );
+#else
+  return constructStar_h < Points<3> > ( W, pts, arena );
+#endif
+}
 
-      Star::iterator from = findNextVisible    (to           , tstar.end(), tstar.id, pid, geom);
-      if ( from != tstar.end() ) {     // If there's nothing to delete
-	advance(from,1);	       // don't delete the first vertex
-	tstar.erase(from,tstar.end()); // be careful if to and from overlap (should be impossible)
-      }
-      tstar.insert(tstar.end(),pid);
-    }
-    else {
-      Star::iterator from = findNextVisible    (tstar.begin(),tstar.end(), tstar.id, pid, geom);
-      Star::iterator to   = findNextNotVisible (from         ,tstar.end(), tstar.id, pid, geom);
-      if ( from == tstar.end() ) continue;			   // If there's nothing to delete
-
-      advance(from,1);		    // don't delete the first vertex
-      to = tstar.erase ( from,to ); // be careful if from==to (I don't think this happens)
-      tstar.insert(to,pid);
+// Stars are built on the thread pool. Working sets range from 3 points to
+// hundreds, so consecutive sets are grouped into tasks of about the same
+// number of points, several per thread, and idle threads steal tasks.
+// Each thread keeps its own stars in arenas, which are merged in task order
+// so the stars are in id order whatever the number of threads.
+template < typename Pts >
+void constructStars   ( StarSet &S,
+			vector < StarArena > &arenas,
+			const WorkingSets &W,
+			const Pts &pts )
+{
+  const auto   pool   = threadPool();
+  const size_t points = W.neighbours.size();
+  const size_t nTasks = std::max < size_t > ( 1, std::min ( STARTASKS*pool->size(), W.size() ) );
+
+  // Task t builds the stars of sets [first[t],first[t+1])
+  vector < size_t > first ( nTasks+1, W.size() );
+  for ( size_t t=0; t<nTasks; t++ )
+    first[t] = std::lower_bound ( W.offsets.begin(), W.offsets.end()-1, t*points/nTasks ) - W.offsets.begin();
+
+  struct Output { size_t worker, begin, end; };
+  vector < Output > output ( nTasks );
+  if ( arenas.size() < pool->size() ) arenas.resize ( pool->size() );
+  for ( auto &a : arenas ) a.clear();
+
+  pool->run ( nTasks, [&] ( size_t t, size_t worker ) {
+      StarArena &out = arenas[worker];
+      output[t] = Output { worker, out.size(), 0 };
+      for ( size_t i=first[t]; i<first[t+1]; i++ )
+	if ( W[i].size() >= 3 ) constructStar_h < Pts > ( W[i], pts, out );
+      output[t].end = out.size();
+    } );
+
+  S.stars.reserve ( W.size() );
+  for ( const auto &o : output )
+    for ( size_t i=o.begin; i<o.end; i++ ) S.add ( arenas[o.worker][i] );
+}
+
+// Position of id in the edges of a star, or its size
+static size_t findEdge ( const Star &s, size_t id ) {
+  for ( size_t i=0; i<s.size(); i++ ) if ( s[i] == id ) return i;
+  return s.size();
+}
+
+// Does the star of t have v with prev before it and next after it
+static bool hasWedge ( const Star &s, size_t prev, size_t v, size_t next ) {
+  const size_t m = s.size(), i = findEdge ( s, v );
+  return i < m && s[(i+m-1)%m] == prev && s[(i+1)%m] == next;
+}
+
+// Inserts ids into a star, queueing the stars affected if it changes
+template < typename T, typename Pts >
+static bool splayInsert ( Star s, const T &ids, const Pts &pts, SplayQueue &Q, size_t &nChanges ) {
+  static thread_local vector < uint32_t > old;
+  bool changed = false;
+  for ( auto id : ids ) {
+    if ( !s.alive() ) break;
+    old.assign ( s.begin(), s.end() );
+    if ( insertIntoStar ( s, id, pts ) != HIDDEN ) {
+      Q.push ( s.id() ); Q.pushAll ( old ); Q.push ( id );
+      changed = true;
+      nChanges++;
     }
-    vector < Triangle > tt;
-    for ( size_t i=0; i<tstar.size()-1; i++ ) {
-      tt.push_back ( Triangle ( tstar.id, tstar[i], tstar[i+1], geom ) );
+  }
+  return changed;
+}
+
+// Makes the star of v consistent with the stars of its neighbours
+// Triangles (v,t_next,t) and (v,t,t_prev) of v's star need v between t_next
+// and t_prev in the star of t. Where they aren't, v and its neighbours are
+// inserted into t's star, and if t's star still disagrees its edges are
+// inserted into v's star. A dead neighbour gives v the points enclosing it.
+// Returns as soon as v's star changes, v is queued again
+template < typename Pts >
+static void splayStar ( StarSet &S, size_t v, const Pts &pts, SplayQueue &Q, size_t &nChanges ) {
+  const size_t m = S[v].size();
+
+  for ( size_t j=0; j<m; j++ ) {
+    const Star     sv = S[v];
+    const uint32_t t  = sv[j], next = sv[(j+1)%m], prev = sv[(j+m-1)%m];
+
+    if ( !S.has ( t ) ) {
+      S.add ( t ).assign ( { next, uint32_t(v), prev } );
+      Q.push ( t );
+      continue;
     }
-    tt.push_back ( Triangle ( tstar.id, tstar.back(), tstar.front(), geom ) );
-    ch.update (tt.begin(),tt.end() );
+
+    Star st = S[t];
+    if ( st.alive() && hasWedge ( st, next, v, prev ) ) continue;
+    const uint32_t wedge[3] = { uint32_t(v), next, prev };
+    if ( st.alive() ) splayInsert ( st, wedge, pts, Q, nChanges );
+    if ( st.alive() && hasWedge ( st, next, v, prev ) ) continue;
+
+    // Copy, inserting into v can grow its ring
+    static thread_local vector < uint32_t > edges;
+    edges.assign ( st.begin(), st.end() );
+    if ( splayInsert ( sv, edges, pts, Q, nChanges ) ) return;
+  }
+}
+
+// Splays until every star agrees with its neighbours
+template < typename Pts >
+static void splayStars ( StarSet &S, SplayQueue &Q, const Pts &pts, size_t nPoints ) {
+  size_t nChanges = 0;
+  while ( !Q.empty() ) {
+    const size_t v = Q.pop();
+    if ( !S.has ( v ) || !S[v].alive() ) continue;
+    splayStar ( S, v, pts, Q, nChanges );
+    if ( nChanges > SPLAYLIMIT*nPoints ) errorM("Star splaying did not converge");
   }
+}
 
-  ch.print ( "initialStar.txt" );
-  return tstar;
+// Each triangle is taken from the star of its lowest id, tris gets the
+// three ids of each one after the other
+static void hullTriangles ( StarSet &S, vector < uint32_t > &tris ) {
+  tris.clear();
+  for ( size_t k=0; k<S.stars.size(); k++ ) {
+    const Star s = S.stars[k];
+    if ( !s.alive() ) continue;
+    const size_t m = s.size();
+    for ( size_t i=0; i<m; i++ )
+      if ( s.id() < s[i] && s.id() < s[(i+1)%m] ) tris.insert ( tris.end(), { s.id(), s[i], s[(i+1)%m] } );
+  }
 }
 
+// Double precision planes, results within PLANEBOUND M^3 of zero are checked
+// with isVisible, so both agree on every point
+template < typename Pts >
+static HullPlane hullPlane ( const Pts &pts, const uint32_t tri[3] ) {
+  const auto A = pts[tri[0]], B = pts[tri[1]], C = pts[tri[2]];
+  const double x[3] = { double(B.x)-A.x, double(B.y)-A.y, double(B.z)-A.z };
+  const double y[3] = { double(C.x)-A.x, double(C.y)-A.y, double(C.z)-A.z };
+  return HullPlane { { x[1]*y[2] - x[2]*y[1], x[2]*y[0] - x[0]*y[2], x[0]*y[1] - x[1]*y[0] },
+		     { double(A.x), double(A.y), double(A.z) } };
+}
 
-void constructStars   ( vector < Star >& S, 
-			const vector < WorkingSet > &W, 
-			const CompGeom::Geometry &geom ) 
+// Points outside the hull which the projection missed, each with a
+// triangle of the hull it can see. Points that already have a star are
+// skipped, as are points in the largest ball about the centre of the
+// hull's vertices that fits inside it.
+// A missed point lost its pixels to points next to it, so the triangles of
+// their stars are tried before every plane of the hull
+// The triangles are ws.triangles() and the points found go in ws.outside()
+template < typename Pts, typename Cell >
+static void findOutsidePoints ( HullWorkspace &ws, const Pts &pts, size_t nPoints, const Cell &cell )
 {
-  // StarHull shull(geom);
-  for ( auto& wset : W ) {
-    // try { 
-    Star tstar = constructStar_h ( wset, geom );
-    if ( !tstar.empty() ) {
-      S.push_back(tstar);
+  const BoundingBox	       &B      = ws.box();
+  StarSet		       &S      = ws.stars();
+  const vector < uint32_t >    &hull   = ws.triangles();
+  const size_t		        nTris  = hull.size() / 3;
+  vector < HullPlane >	       &planes = ws.planes();
+
+  double centre[3] = { 0, 0, 0 };
+  planes.clear();
+  for ( size_t f=0; f<nTris; f++ ) {
+    planes.push_back ( hullPlane ( pts, &hull[3*f] ) );
+    for ( size_t a=0; a<3; a++ ) centre[a] += double ( pts.coord ( hull[3*f], a ) ) / nTris;
+  }
+
+  double radius2 = std::numeric_limits<double>::max();
+  for ( const auto &P : planes ) {
+    const double *n = P.normal;
+    const double  d = n[0]*(P.origin[0]-centre[0]) + n[1]*(P.origin[1]-centre[1]) + n[2]*(P.origin[2]-centre[2]);
+    radius2 = std::min ( radius2, d > 0 ? d*d / (n[0]*n[0] + n[1]*n[1] + n[2]*n[2]) : 0 );
+  }
+  radius2 *= 1 - 1e-3;
+
+  const double M     = maxAbsCoord ( pts );
+  const double bound = PLANEBOUND * M*M*M;
+
+  const size_t nBlocks = std::max < size_t > ( 1, std::min ( nPoints / PROJBLOCK, 4*numThreads() ) );
+  auto &found = ws.found();
+  if ( found.size() < nBlocks ) found.resize ( nBlocks );
+  for ( auto &f : found ) f.clear();
+
+  // The first triangle of q's star p can see
+  auto seesStar = [&] ( size_t p, uint32_t q, OutsidePoint &out ) {
+    if ( q == Tile::noID() || !S.has ( q ) || !S[q].alive() ) return false;
+    const Star   s = S[q];
+    const size_t m = s.size();
+    for ( size_t k=0; k<m; k++ ) {
+      if ( isVisible ( pts, q, s[k], s[(k+1)%m], p ) ) {
+	out = OutsidePoint { p, { q, s[k], s[(k+1)%m] } };
+	return true;
+      }
+    }
+    return false;
+  };
+
+  parallelFor ( nBlocks, [&] ( size_t b ) {
+      for ( size_t p = b*nPoints/nBlocks; p < (b+1)*nPoints/nBlocks; p++ ) {
+	if ( S.has ( p ) ) continue;
+	const double x[3] = { double ( pts.x(p) ), double ( pts.y(p) ), double ( pts.z(p) ) };
+	const double r[3] = { x[0]-centre[0], x[1]-centre[1], x[2]-centre[2] };
+	if ( r[0]*r[0] + r[1]*r[1] + r[2]*r[2] < radius2 ) continue;
+
+	int	     id[DIM];
+	float	     depth[2*DIM];
+	OutsidePoint out;
+	bool	     seen = false;
+	cell ( p, id, depth );
+	for ( size_t i=0; i<DIM && !seen; i++ ) {
+	  const Direction::Dir face = frontFace ( B, i, depth );
+	  if ( B.hasFace ( face ) ) seen = seesStar ( p, B[face].getID ( id[(i+1)%DIM], id[(i+2)%DIM] ), out );
+	}
+
+	for ( size_t f=0; f<nTris && !seen; f++ ) {
+	  const double   *n = planes[f].normal, *o = planes[f].origin;
+	  const double    s = n[0]*(x[0]-o[0]) + n[1]*(x[1]-o[1]) + n[2]*(x[2]-o[2]);
+	  const uint32_t *t = &hull[3*f];
+	  if ( s > bound || ( s > -bound && isVisible ( pts, t[0], t[1], t[2], p ) ) ) {
+	    out  = OutsidePoint { p, { t[0], t[1], t[2] } };
+	    seen = true;
+	  }
+	}
+	if ( seen ) found[b].push_back ( out );
+      }
+    } );
+
+  vector < OutsidePoint > &outside = ws.outside();
+  outside.clear();
+  for ( size_t b=0; b<nBlocks; b++ ) outside.insert ( outside.end(), found[b].begin(), found[b].end() );
+}
+
+// Star splaying, turns the stars of the working sets into the hull
+// Once the stars agree, points outside the hull get a star over a triangle
+// they see and splaying starts again. This only ends once every point is
+// inside, points given a star this way are never looked at again.
+// The stars before each round are written to trace unless it is NULL
+template < typename Pts, typename Cell >
+static vector < vector < size_t > > splayHull ( HullWorkspace &ws, const Pts &pts, size_t nPoints,
+						const Cell &cell, StarHull *trace )
+{
+  StarSet		    &S    = ws.stars();
+  SplayQueue		    &Q    = ws.splayQueue();
+  const vector < uint32_t > &tris = ws.triangles();
+  Q.reset ( nPoints );
+  for ( size_t k=0; k<S.stars.size(); k++ ) Q.push ( S.stars[k].id() );
+
+  while ( true ) {
+    if ( trace ) trace->update ( S.stars );
+    splayStars ( S, Q, pts, nPoints );
+    hullTriangles ( S, ws.triangles() );
+    if ( tris.empty() ) errorM("Star splaying didn't find a hull");
+
+    findOutsidePoints ( ws, pts, nPoints, cell );
+    if ( ws.outside().empty() ) break;
+
+    for ( const auto &o : ws.outside() ) {
+      S.add ( o.id ).assign ( o.tri, o.tri+3 );
+      Q.push ( o.id );
     }
-    // shull.update(S.begin(),S.end());
-    
-    // } catch( std::logic_error &e ) {
-    //   cout << __LINE__ << " " << e.what() << endl;
-    //   for ( auto ei : wset ) 
-    // 	cout << ei.first <<" " << ei.second << endl;
-    // }
   }
-  // shull.print("test_starset.txt");
+
+  vector < vector < size_t > > hull ( tris.size() / 3 );
+  for ( size_t f=0; f<hull.size(); f++ ) hull[f].assign ( &tris[3*f], &tris[3*f+3] );
+  return hull;
 }
 
-vector < vector < size_t > > gHullSerial ( const CompGeom::Geometry &geom ) {
-  if ( geom.size()    < 4 ) errorM("3D geometry needs at least for non-coplanar points to be a convex hull"); 
-  if ( geom.getDim() != 3 ) errorM("gHullSerial only works in 3 dimensions");
+// The pba engines need a resolution the band sizes divide
+static void checkResolution ( size_t res, VoronoiEngine engine ) {
+  if ( res < 2 || res > MAXRES )
+    errorM("Resolution must be between 2 and 16384");
+  if ( engine == PBA_GPU && ( res < 64 || (res & (res-1)) ) )
+    errorM("The GPU Voronoi engine needs a power of 2 resolution of at least 64");
+  if ( engine == PBA_CPU && ( res % P1B || res % P2B || res % P3B ) )
+    errorM("The CPU PBA Voronoi engine needs a resolution divisible by its band sizes");
+}
 
-  CompGeom::BoundingBox  B  (BOXSIZE );
-  vector < Voronoi     > V  (DIM    ,Voronoi(BOXSIZE, VoronoiRow(BOXSIZE, vector < short > (2) ) ) );
-  vector < WorkingSet  > W; 
-  vector < Star        > S;
+// Seconds since t, t is reset to now
+static float lap ( chrono::steady_clock::time_point &t ) {
+  const auto now = chrono::steady_clock::now();
+  const float s  = chrono::duration_cast < chrono::duration < float > > ( now - t ).count();
+  t = now;
+  return s;
+}
 
+// The same for float and integer points, only the projection and the
+// predicates differ
+template < typename Pts >
+static vector < vector < size_t > > gHullSerialOf ( const Pts &geom,
+						    HullWorkspace &ws,
+						    VoronoiEngine engine,
+						    size_t resolution,
+						    GHullTimings *timings )
+{
+  if ( geom.size()    < 4 ) errorM("3D geometry needs at least for non-coplanar points to be a convex hull"); 
 
-  projectToBox         ( B, geom    );
-  constructVoronois    ( B, V       );
-  constructWorkingSets ( W, B, V    );
-  constructStars       ( S, W, geom );
+  // Compiled with TRACE_HULLS the rounds of star splaying are written to starSplaying.txt
+#ifdef TRACE_HULLS
+  StarHull  trace ( geom, "starSplaying.txt" );
+  StarHull *splayTrace = &trace;
+#else
+  StarHull *splayTrace = NULL;
+#endif
+
+  GHullTimings t;
+  auto         clock = chrono::steady_clock::now();
+
+  const auto extremes = findExtremes2 ( geom );
+  if ( resolution == ADAPTIVE_RESOLUTION )
+    resolution = adaptiveResolution ( geom.size(), extremes );
+  checkResolution ( resolution, engine );
+
+  // Only allocates if the resolution or engine changed since the last call
+  ws.prepare ( resolution, engine );
+  WorkingSets &W = ws.workingSets();
+  StarSet     &S = ws.stars();
+  S.reset ( geom.size() );
+
+  projectToBox         ( ws, geom, extremes );		t.projection  = lap ( clock );
+  constructVoronois    ( ws );				t.voronoi     = lap ( clock );
+  constructWorkingSets ( W, ws, geom.size() );		t.workingSets = lap ( clock );
+
+  constructStars       ( S, ws.arenas(), W, geom );		t.stars       = lap ( clock );
+  auto hull = splayHull ( ws, geom, geom.size(), boxCell ( ws, geom, extremes ), splayTrace );	t.splaying    = lap ( clock );
+
+  if ( timings ) *timings = t;
+  return hull;
+}
 
-  // makeVoronoiPBM(V[Direction::LEFT],"images/voronoi_left.pbm" ,B[Direction::LEFT ]);
-  // makeVoronoiPBM(V[Direction::BACK],"images/voronoi_back.pbm" ,B[Direction::BACK ]);
-  // makeVoronoiPBM(V[Direction::DOWN],"images/voronoi_down.pbm" ,B[Direction::DOWN ]);
-  // makeVoronoiPBM(V[Direction::LEFT],"images/voronoi_right.pbm",B[Direction::RIGHT]);
-  // makeVoronoiPBM(V[Direction::BACK],"images/voronoi_front.pbm",B[Direction::FRONT]);
-  // makeVoronoiPBM(V[Direction::DOWN],"images/voronoi_up.pbm"   ,B[Direction::UP   ]);
+vector < vector < size_t > > gHullSerial ( const Points<3> &geom,
+					   HullWorkspace &ws,
+					   VoronoiEngine engine,
+					   size_t resolution,
+					   GHullTimings *timings )
+{
+  return gHullSerialOf ( geom, ws, engine, resolution, timings );
+}
 
-  
-  return vector < vector < size_t > > ( 1,{0,1,2} );
+vector < vector < size_t > > gHullSerial ( const IntPoints<3> &geom,
+					   HullWorkspace &ws,
+					   VoronoiEngine engine,
+					   size_t resolution,
+					   GHullTimings *timings )
+{
+  return gHullSerialOf ( geom, ws, engine, resolution, timings );
 }
 
+vector < vector < size_t > > gHullSerial ( const CompGeom::Geometry &geom,
+					   HullWorkspace &ws,
+					   VoronoiEngine engine,
+					   size_t resolution,
+					   GHullTimings *timings )
+{
+  if ( geom.getDim() != 3 ) errorM("gHullSerial only works in 3 dimensions");
+  ws.points().assign ( geom );
+  return gHullSerial ( ws.points(), ws, engine, resolution, timings );
+}
+
+vector < vector < size_t > > gHullSerial ( const CompGeom::Geometry &geom,
+					   VoronoiEngine engine,
+					   size_t resolution )
+{
+  HullWorkspace ws ( 0, engine );
+  return gHullSerial ( geom, ws, engine, resolution );
+}
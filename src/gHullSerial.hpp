@@ -2,15 +2,76 @@
  * Name    : gHullSerial.hpp
  * Author  : Kevin Mooney
  * Created : 16/08/16
- * Updated :
+ * Updated : 17/10/26
  *
  * Description:
+ *   Serial version of gHull, the points are projected
+ *   onto the faces of their bounding box, the dual of
+ *   the faces' Voronoi diagrams gives a star for each
+ *   point and star splaying makes these into the hull
  *
  * NOTES:
+ *   - Triangles are anti-clockwise viewed from outside,
+ *     the same as insertion3D
  ******************************************************/
 
 #pragma once
 
+#include <vector>
+
+#include "boundingBox.hpp"
 #include "geometry.hpp"
+#include "geometryHelper.hpp"
+#include "hullWorkspace.hpp"
+#include "intPoints.hpp"
+#include "points.hpp"
+#include "voronoi.hpp"
+
+// Seconds spent in each phase of a gHullSerial call
+struct GHullTimings {
+  float projection;		// Projecting the points onto the box
+  float voronoi;		// Voronoi diagrams of the faces
+  float workingSets;		// Dual edges of the diagrams
+  float stars;			// Initial stars from the working sets
+  float splaying;		// Star splaying into the hull
+};
+
+// resolution is the width of the tiles, up to 16384
+// ADAPTIVE_RESOLUTION picks it from the input, but never above 2048
+std::vector < std::vector < size_t > > gHullSerial ( const CompGeom::Geometry &geom, 
+						     VoronoiEngine engine = DEFAULT_VORONOI_ENGINE,
+						     size_t resolution    = DEFAULT_RESOLUTION );
+
+// Same as above, reusing the buffers of ws between calls
+// The time of each phase is written to timings if it isn't NULL
+std::vector < std::vector < size_t > > gHullSerial ( const CompGeom::Geometry &geom, 
+						     CompGeom::HullWorkspace &ws,
+						     VoronoiEngine engine   = DEFAULT_VORONOI_ENGINE,
+						     size_t resolution      = DEFAULT_RESOLUTION,
+						     GHullTimings *timings  = NULL );
+
+// Same as above on points already in arrays, the Geometry versions copy
+// the points into arrays once and call this
+std::vector < std::vector < size_t > > gHullSerial ( const CompGeom::Points<3> &geom,
+						     CompGeom::HullWorkspace &ws,
+						     VoronoiEngine engine   = DEFAULT_VORONOI_ENGINE,
+						     size_t resolution      = DEFAULT_RESOLUTION,
+						     GHullTimings *timings  = NULL );
+
+// Integer points, the projection bins them exactly and the stars are built
+// and splayed with integer determinants
+std::vector < std::vector < size_t > > gHullSerial ( const CompGeom::IntPoints<3> &geom,
+						     CompGeom::HullWorkspace &ws,
+						     VoronoiEngine engine   = DEFAULT_VORONOI_ENGINE,
+						     size_t resolution      = DEFAULT_RESOLUTION,
+						     GHullTimings *timings  = NULL );
 
-std::vector < std::vector < size_t > > gHullSerial ( const CompGeom::Geometry &geom );
+// The phases of gHullSerial, exposed for benchmarking
+// ws must be prepared for the resolution and engine first
+void projectToBox      ( CompGeom::HullWorkspace &ws, const CompGeom::Points<3> &geom,
+			 const std::vector < float > &extremes );
+void projectToBox      ( CompGeom::HullWorkspace &ws, const CompGeom::Geometry &geom,
+			 const std::vector < float > &extremes );
+void projectToBox      ( CompGeom::HullWorkspace &ws, const CompGeom::IntPoints<3> &geom,
+			 const std::vector < int32_t > &extremes );
+void constructVoronois ( CompGeom::HullWorkspace &ws );
@@ -2,7 +2,7 @@
  * Name    : geometry.hpp
  * Author  : Kevin Mooney
  * Created : 13/06/16
- * Updated : 19/07/16
+ * Updated : 17/10/26
  *
  * Description:
  *   Vector wrap around class for storing a list of coordinates
@@ -13,7 +13,8 @@
  *   - Make addRandom work for generic box sizes
  *   - Add points from file
  *   - Add method for checking integrity of geometry 
- *   - Template the dimension of the geometry
+ *   - Template the dimension of the geometry, see
+ *     Points in points.hpp
  *
  * Notes:
  *   - Normal distribution gives uninitialised warnings
@@ -55,7 +56,7 @@ namespace CompGeom {
     size_t size() const { return coords.size(); }
     size_t getDim() const { return dim; }
 
-    Point operator   [](int i) const  {return coords[i];}
+    const Point &operator[](int i) const  {return coords[i];}
     Point &operator  [](int i)        {return coords[i];}
 
     // Adds N random points, in a box around the origin
@@ -2,41 +2,105 @@
  * Name    : geometryHelper.cpp
  * Author  : Kevin Mooney
  * Created : 16/08/16
- * Updated :
+ * Updated : 17/10/26
  *
  * Description:
  *
  * NOTES:
  ******************************************************/
 
+#include <algorithm>
+#include <cstdint>
+#include <cmath>
+#include <limits>
 #include <vector>
 
 #include "directionEnums.hpp"
 #include "geometry.hpp"
+#include "geometryHelper.hpp"
+#include "intPoints.hpp"
+#include "parallel.hpp"
+#include "points.hpp"
+
+#define EXTBLOCK 65536		// Fewest points given to one thread by findExtremes2
+#define MINRES   64		// Smallest texture pba accepts
+#define MAXADAPTIVERES 2048	// Largest resolution picked automatically, below
+				// the MAXRES of gHullSerial to bound tile memory
 
-// Finds the minimum and maximum coordinates in all dimensions
-// This could be reduced to stl functions with lambdas
-// check minmax_element
 std::vector < float > findExtremes2 ( const CompGeom::Geometry &geom ) {
-  using namespace Direction;
-  std::vector < float > ext(6);
-  
-  // Set initial values for the mins and maxes
-  // for ( int i=0; i<3; i++ ) {
-  for ( auto dir : Direction::allDirections() ) { 
-    size_t i = dir % 3;
-    ext[i] = geom[0][i];
-  }
-  // Loop over all points and update min or max if necessary
-  for ( auto p : geom ) {
-    for ( auto dir : {LEFT, DOWN, BACK } ) { 
-      size_t i = dir % 3;
-      ext[dir] = std::min(ext[dir],p[i]);
+  if ( geom.getDim() != 3 ) errorM("findExtremes2 only works in 3 dimensions");
+  return findExtremes2 ( CompGeom::Points<3> ( geom ) );
+}
+
+// Finds the minimum and maximum coordinates in all dimensions
+// Each block of points is reduced on its own, then the blocks are combined
+// Each axis is a separate array, so the inner loops are straight min/max
+// reductions over contiguous coordinates of type T
+template < typename T, typename Pts >
+static std::vector < T > extremesOf ( const Pts &geom ) {
+  const size_t n       = geom.size();
+  const size_t nBlocks = std::max < size_t > ( 1, std::min ( n / EXTBLOCK, 4*CompGeom::numThreads() ) );
+  std::vector < std::vector < T > > blockExt ( nBlocks );
+
+  CompGeom::parallelFor ( nBlocks, [&] ( size_t b ) {
+      const size_t first = b*n/nBlocks, last = (b+1)*n/nBlocks;
+      T mins[3], maxs[3];
+
+      for ( size_t a=0; a<3; a++ ) {
+	const T *x = geom.axis ( a );
+	mins[a] = maxs[a] = x[first];
+	for ( size_t i=first; i<last; i++ ) {
+	  mins[a] = std::min ( mins[a], x[i] );
+	  maxs[a] = std::max ( maxs[a], x[i] );
+	}
+      }
+      blockExt[b] = { mins[0], mins[1], mins[2], maxs[0], maxs[1], maxs[2] };
+    } );
+
+  // Direction enums index the result, LEFT, BACK and DOWN are the mins
+  std::vector < T > ext = blockExt[0];
+  for ( const auto &be : blockExt ) {
+    for ( size_t i=0; i<3; i++ ) {
+      ext[i  ] = std::min ( ext[i  ], be[i  ] );
+      ext[i+3] = std::max ( ext[i+3], be[i+3] );
     }
-    for ( auto dir : {RIGHT, UP, FRONT } ) { 
-      size_t i = dir % 3;
-      ext[dir] = std::max(ext[dir],p[i]);
-    }  
-  }  
+  }
   return ext;
 }
+
+std::vector < float > findExtremes2 ( const CompGeom::Points<3> &geom ) {
+  return extremesOf < float > ( geom );
+}
+
+std::vector < int32_t > findExtremes2 ( const CompGeom::IntPoints<3> &geom ) {
+  return extremesOf < int32_t > ( geom );
+}
+
+// Aims for about one pixel per point along each side of a tile.
+// The tiles are square but the box isn't, so stretched boxes get
+// more pixels to keep the short side resolved.
+// The extents are taken as doubles so integer boxes can't overflow
+template < typename T >
+static size_t adaptiveResolutionOf ( size_t n, const std::vector < T > &ext ) {
+  double min_extent = std::numeric_limits<double>::max();
+  double max_extent = 0;
+  for ( size_t i=0; i<3; i++ ) {
+    min_extent = std::min ( min_extent, double ( ext[i+3] ) - double ( ext[i] ) );
+    max_extent = std::max ( max_extent, double ( ext[i+3] ) - double ( ext[i] ) );
+  }
+
+  double target = std::sqrt ( double(n) );
+  if ( min_extent > 0 ) target *= std::sqrt ( max_extent / min_extent );
+
+  size_t res = MINRES;
+  while ( res < target && res < MAXADAPTIVERES ) res *= 2;
+  return res;
+}
+
+size_t adaptiveResolution ( size_t n, const std::vector < float > &ext ) {
+  return adaptiveResolutionOf ( n, ext );
+}
+
+size_t adaptiveResolution ( size_t n, const std::vector < int32_t > &ext ) {
+  return adaptiveResolutionOf ( n, ext );
+}
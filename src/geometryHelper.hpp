@@ -2,7 +2,7 @@
  * Name    : geometryHelper.hpp
  * Author  : Kevin Mooney
  * Created : 25/07/16
- * Updated :
+ * Updated : 17/10/26
  *
  * Description:
  *
@@ -11,10 +11,28 @@
 
 #pragma once
 
+#include <cstdint>
 #include <vector>
 
+#include "geometry.hpp"
+#include "intPoints.hpp"
+#include "points.hpp"
+
+// Resolutions of the projections onto the bounding box
+const size_t DEFAULT_RESOLUTION  = 512;
+const size_t ADAPTIVE_RESOLUTION = 0;	// Pick the resolution from the input, at most 2048
+
 // Finds the minimum and maximum coordinates in all dimensions
-std::vector < float > findExtremes2 ( const CompGeom::Geometry &geom );
+std::vector < float > findExtremes2 ( const CompGeom::Geometry  &geom );
+std::vector < float > findExtremes2 ( const CompGeom::Points<3> &geom );
+std::vector < int32_t > findExtremes2 ( const CompGeom::IntPoints<3> &geom );
+
+// Picks a power of 2 resolution for the projections of n points
+// inside the box given by findExtremes2
+// It stops at 2048 however many points there are, even for 10M,
+// larger resolutions up to 16384 must be asked for explicitly
+size_t adaptiveResolution ( size_t n, const std::vector < float   > &extremes );
+size_t adaptiveResolution ( size_t n, const std::vector < int32_t > &extremes );
 
 // Deprecated
 // Finds the minimum and maximum coordinates in all dimensions
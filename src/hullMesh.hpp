@@ -0,0 +1,123 @@
+/******************************************************
+ * Name    : hullMesh.hpp
+ * Author  : Kevin Mooney
+ * Created : 17/10/26
+ * Updated :
+ *
+ * Description:
+ *   Triangles of a closed hull with the half edges
+ *   that join them up
+ *
+ * NOTES:
+ *   - Half edge e runs from vertex e%3 of triangle e/3
+ *     to the next vertex of it. Its twin runs the other
+ *     way along the triangle on the other side
+ *   - Triangles are anti-clockwise viewed from outside,
+ *     the same as insertion3D. The boundary of a cap of
+ *     triangles is the half edges whose twins are
+ *     outside it
+ *   - Removed triangles leave their slot empty and on a
+ *     free list, the next triangles added take them, so
+ *     nothing moves while the hull is built. Edges joined
+ *     to a removed triangle are left as they are, it is
+ *     up to the caller to join them again. compact()
+ *     closes the gaps once it is done
+ ******************************************************/
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#define NOEDGE   0xFFFFFFFFu		// Twin of an edge not joined up yet
+#define NOVERTEX 0xFFFFFFFFu		// Vertices of an empty slot
+
+namespace CompGeom {
+
+  class HullMesh {
+  private:
+    std::vector < std::array < uint32_t, 3 > > _tris;
+    std::vector < uint32_t >                   _twin;
+    std::vector < uint32_t >                   _free;	// Empty slots, the last is taken first
+
+  public:
+    // Slots, including the empty ones
+    size_t size  () const { return _tris.size(); }
+    // Triangles in the slots
+    size_t count () const { return _tris.size() - _free.size(); }
+    bool   empty () const { return count() == 0; }
+
+    bool alive ( uint32_t f ) const { return _tris[f][0] != NOVERTEX; }
+
+    const std::array < uint32_t, 3 > &operator[] ( size_t f ) const { return _tris[f]; }
+
+    static uint32_t face  ( uint32_t e ) { return e / 3; }
+    static uint32_t edge  ( uint32_t f, uint32_t k ) { return 3*f + k; }
+    static uint32_t next  ( uint32_t e ) { return e % 3 == 2 ? e - 2 : e + 1; }
+
+    uint32_t twin   ( uint32_t e ) const { return _twin[e]; }
+    uint32_t origin ( uint32_t e ) const { return _tris[e/3][e%3]; }
+    uint32_t target ( uint32_t e ) const { return origin ( next ( e ) ); }
+
+    // Triangle across edge k of triangle f
+    uint32_t neighbour ( uint32_t f, uint32_t k ) const { return face ( _twin[edge ( f, k )] ); }
+
+    // Returns the slot of the new triangle, its edges aren't joined up
+    uint32_t add ( uint32_t id0, uint32_t id1, uint32_t id2 ) {
+      if ( _free.empty() ) {
+	_tris.push_back ( {{ id0, id1, id2 }} );
+	_twin.insert ( _twin.end(), 3, NOEDGE );
+	return uint32_t ( _tris.size() - 1 );
+      }
+      const uint32_t f = _free.back();
+      _free.pop_back();
+      _tris[f] = {{ id0, id1, id2 }};
+      for ( uint32_t k=0; k<3; k++ ) _twin[edge ( f, k )] = NOEDGE;
+      return f;
+    }
+
+    void link ( uint32_t e0, uint32_t e1 ) { _twin[e0] = e1; _twin[e1] = e0; }
+
+    void remove ( uint32_t f ) {
+      _tris[f] = {{ NOVERTEX, NOVERTEX, NOVERTEX }};
+      _free.push_back ( f );
+    }
+
+    // Moves the triangles down into the empty slots, keeping their order.
+    // Returns the new slot of each old one, NOEDGE for the empty ones
+    std::vector < uint32_t > compact () {
+      std::vector < uint32_t > to ( _tris.size(), NOEDGE );
+      uint32_t n = 0;
+      for ( uint32_t f=0; f<_tris.size(); f++ )
+	if ( alive ( f ) ) to[f] = n++;
+
+      for ( uint32_t f=0; f<_tris.size(); f++ ) {
+	if ( !alive ( f ) ) continue;
+	_tris[to[f]] = _tris[f];
+	for ( uint32_t k=0; k<3; k++ ) {
+	  const uint32_t e = _twin[edge ( f, k )];
+	  const bool     joined = e != NOEDGE && to[face ( e )] != NOEDGE;
+	  _twin[edge ( to[f], k )] = joined ? edge ( to[face ( e )], e % 3 ) : NOEDGE;
+	}
+      }
+      _tris.resize ( n );
+      _twin.resize ( 3*n );
+      _free.clear();
+      return to;
+    }
+
+    // The triangles in order, without the empty slots
+    std::vector < std::array < uint32_t, 3 > > triangles () const {
+      std::vector < std::array < uint32_t, 3 > > tris;
+      tris.reserve ( count() );
+      for ( uint32_t f=0; f<_tris.size(); f++ )
+	if ( alive ( f ) ) tris.push_back ( _tris[f] );
+      return tris;
+    }
+
+    // Empties the mesh, keeping its memory for the next hull
+    void clear () { _tris.clear(); _twin.clear(); _free.clear(); }
+  };
+}
@@ -0,0 +1,448 @@
+/******************************************************
+ * Name    : hullRounds.cpp
+ * Author  : Kevin Mooney
+ * Created : 17/10/26
+ * Updated :
+ *
+ * Description:
+ *
+ * NOTES:
+ *   - Every face with points outside it puts forward one
+ *     of them and the faces it sees are found on the
+ *     thread pool. Going through them in order, each one
+ *     whose visible faces and horizon don't touch those
+ *     of one before it is added in this round
+ *   - A point can't see the new faces of a point added in
+ *     the same round: it would have to see one of the two
+ *     faces either side of their horizon edge, which it
+ *     was checked not to. So the points of a round can be
+ *     added in any order
+ *   - With ranks the points are put forward in rank order
+ *     and one that isn't added still blocks the points
+ *     after it. For points in general position the hull
+ *     is the same as adding them one at a time in rank
+ *     order, flat faces may be split differently
+ *   - The points of the removed faces are handed on to
+ *     the new faces in blocks of up to PARTITIONBLOCK,
+ *     grouped into tasks of at least that many points so
+ *     the many small caps of a round share tasks. A block
+ *     is tested against each new face with
+ *     planeSide and only sides within the error bound are
+ *     worked out again with orient3DExact. A point that
+ *     sees none of them is inside the hull and dropped
+ *   - The blocks are counted first and then copied into
+ *     their faces' lists at offsets worked out in block
+ *     order, so the lists are the same for any number of
+ *     threads
+ *   - Outside lists hold copies of the points, so they
+ *     are read in order
+ ******************************************************/
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "errorMessages.hpp"
+#include "exactPredicates.hpp"
+#include "facePool.hpp"
+#include "hullRounds.hpp"
+#include "predicates.hpp"
+#include "threadPool.hpp"
+#include "triangle.hpp"
+
+#define NOPOINT        0xFFFFFFFFu	// Apex of a face with nothing outside it
+#define PARTITIONBLOCK 8192		// Points tested in one task
+#define REGIONBLOCK    64		// Visible regions found in one task
+
+using namespace std;
+
+namespace {
+
+  // Points outside a face
+  struct Outside {
+    CompGeom::AlignedFloats x, y, z;
+    vector < uint32_t >     id;
+
+    size_t size   () const { return id.size(); }
+    void   resize ( size_t n ) { x.resize ( n ); y.resize ( n ); z.resize ( n ); id.resize ( n ); }
+  };
+
+  // Points being handed on, id is NULL for the input where they are first, first+1, ...
+  struct Block {
+    const float    *x, *y, *z;
+    const uint32_t *id;
+    uint32_t        first;
+    size_t          n;
+
+    uint32_t at ( size_t i ) const { return id ? id[i] : uint32_t ( first + i ); }
+  };
+
+  // A point being added, with the faces it replaces
+  struct Region {
+    uint32_t            apex;
+    vector < uint32_t > visible;
+    vector < uint32_t > horizon;	// Half edges across the horizon from the visible faces
+    vector < uint32_t > fresh;		// New faces
+    vector < Outside >  orphans;	// Points of the visible faces
+    vector < Block >    blocks;
+  };
+
+  // One block of a region being handed on, or part of one
+  struct Piece {
+    size_t region, block, lo, hi;
+    size_t points;	// Offset into the flat arrays of results by point
+    size_t counts;	// Offset into those by new face
+  };
+
+  class HullRounds {
+  private:
+    const CompGeom::Points<3> &geom;
+    const float                bound;	// Error of the planes, see planeSideErrorBound
+    const uint32_t            *rank;	// See hullRounds, NULL to add the farthest points
+    const std::shared_ptr < CompGeom::ThreadPool > threads;
+
+    CompGeom::FacePool         pool;
+    vector < Outside >         outside;	// By slot
+    vector < Outside >         spare;	// Emptied lists, kept for their memory
+    vector < uint32_t >        apex;	// Farthest point outside each slot
+    vector < uint32_t >        startAt;	// New face whose horizon edge starts at each id
+
+    vector < CompGeom::AlignedFloats > scratch;	// PARTITIONBLOCK sides for each worker
+    vector < vector < uint32_t > >     stamp;	// Per worker, by slot, marks faces tested
+    vector < uint32_t >                stamped;	// Per worker, last mark used
+
+    // Results of handing on, see partition
+    vector < Piece >    pieces;
+    vector < size_t >   tasks;	// First piece of each task, then the number of pieces
+    vector < uint32_t > assign;
+    vector < float >    side;
+    vector < uint32_t > place;
+    vector < float >    bestSide;
+    vector < uint32_t > bestId;
+
+    enum Claim : char { FREE, HORIZON, VISIBLE };
+    vector < char >     claim;		// By slot, what taken regions do to each face
+
+  public:
+    HullRounds ( const CompGeom::Points<3> &pts, const uint32_t *order ) :
+      geom    { pts },
+      bound   { CompGeom::planeSideErrorBound ( CompGeom::maxAbsCoord ( pts ) ) },
+      rank    { order },
+      threads ( CompGeom::threadPool() ),
+      startAt ( pts.size() ),
+      scratch ( threads->size(), CompGeom::AlignedFloats ( PARTITIONBLOCK ) ),
+      stamp   ( threads->size() ),
+      stamped ( threads->size(), 0 ) {}
+
+    vector < vector < size_t > > run ( const uint32_t id[4] );
+
+  private:
+
+    // Point id, with side s, is added before point b, with side bs
+    bool before ( uint32_t id, float s, uint32_t b, float bs ) const {
+      return rank ? rank[id] < rank[b] : s > bs;
+    }
+
+    // p is strictly in front of the face in slot f
+    bool sees ( uint32_t f, const CompGeom::Vec3 &p ) const {
+      const float s = pool.nx()[f]*p.x + pool.ny()[f]*p.y + pool.nz()[f]*p.z + pool.d()[f];
+      if ( s >  bound ) return true;
+      if ( s < -bound ) return false;
+      const auto &tri = pool.mesh()[f];
+      return CompGeom::orient3DExact ( geom[tri[0]], geom[tri[1]], geom[tri[2]], p ) > 0;
+    }
+
+    void grow      ( size_t slots );
+    void findRegion ( Region &R, uint32_t f, size_t worker );
+    bool take      ( const Region &R );
+    void apply     ( Region &R );
+    void partition ( vector < Region > &regions );
+
+    // Calls f(piece,worker) for every piece, in tasks of at least PARTITIONBLOCK points
+    template < typename Func >
+    void eachPiece ( Func f ) {
+      threads->run ( tasks.size()-1, [&] ( size_t t, size_t worker ) {
+	  for ( size_t p=tasks[t]; p<tasks[t+1]; p++ ) f ( pieces[p], worker );
+	} );
+    }
+  };
+
+  void HullRounds::grow ( size_t slots ) {
+    if ( outside.size() >= slots ) return;
+    outside.resize ( slots );
+    apex   .resize ( slots, NOPOINT );
+    claim  .resize ( slots, FREE );
+  }
+
+  // The faces the apex of f sees, out from f, and the edges around them
+  void HullRounds::findRegion ( Region &R, uint32_t f, size_t worker ) {
+    typedef CompGeom::HullMesh Mesh;
+    const Mesh          &mesh = pool.mesh();
+    vector < uint32_t > &mark = stamp[worker];
+    const uint32_t       vis  = stamped[worker] += 2, hidden = vis + 1;
+    const CompGeom::Vec3 p    = geom[apex[f]];
+
+    R.apex = apex[f];
+    R.visible.assign ( 1, f );
+    R.horizon.clear();
+    mark[f] = vis;
+    for ( size_t v=0; v<R.visible.size(); v++ ) {
+      for ( uint32_t k=0; k<3; k++ ) {
+	const uint32_t t = mesh.twin ( Mesh::edge ( R.visible[v], k ) );
+	const uint32_t g = Mesh::face ( t );
+	if ( mark[g] != vis && mark[g] != hidden ) {
+	  mark[g] = sees ( g, p ) ? vis : hidden;
+	  if ( mark[g] == vis ) R.visible.push_back ( g );
+	}
+	if ( mark[g] == hidden ) R.horizon.push_back ( t );
+      }
+    }
+  }
+
+  // Takes R unless it removes a face an earlier region touches or touches
+  // a face an earlier region removes. With ranks the earlier regions
+  // include those not taken, as their points come before R's
+  bool HullRounds::take ( const Region &R ) {
+    bool free = true;
+    for ( auto f : R.visible ) free &= claim[f] == FREE;
+    for ( auto t : R.horizon ) free &= claim[CompGeom::HullMesh::face ( t )] != VISIBLE;
+    if ( !free && !rank ) return false;
+
+    for ( auto f : R.visible ) claim[f] = VISIBLE;
+    for ( auto t : R.horizon ) {
+      char &c = claim[CompGeom::HullMesh::face ( t )];
+      if ( c == FREE ) c = HORIZON;
+    }
+    return free;
+  }
+
+  // Replaces the visible faces with a cone from the apex to the horizon
+  void HullRounds::apply ( Region &R ) {
+    typedef CompGeom::HullMesh Mesh;
+    Mesh &mesh = pool.mesh();
+
+    R.orphans.clear();
+    for ( auto f : R.visible ) {
+      R.orphans.push_back ( move ( outside[f] ) );
+      outside[f] = Outside();
+      apex[f]    = NOPOINT;
+      pool.remove ( f );
+    }
+    R.fresh.clear();
+    for ( auto t : R.horizon ) {
+      const uint32_t a = mesh.target ( t ), b = mesh.origin ( t );
+      const uint32_t h = pool.add ( a, b, R.apex, geom );
+      mesh.link ( Mesh::edge ( h, 0 ), t );
+      startAt[a] = h;
+      R.fresh.push_back ( h );
+    }
+    for ( auto h : R.fresh ) {
+      mesh.link ( Mesh::edge ( h, 1 ), Mesh::edge ( startAt[mesh[h][1]], 2 ) );
+    }
+    grow ( pool.size() );
+
+    R.blocks.clear();
+    for ( const auto &o : R.orphans )
+      if ( o.size() ) R.blocks.push_back ( Block { o.x.data(), o.y.data(), o.z.data(), o.id.data(), 0, o.size() } );
+  }
+
+  // Hands the blocks of each region on to its new faces and sets their apexes
+  void HullRounds::partition ( vector < Region > &regions ) {
+    pieces.clear();
+    tasks.assign ( 1, 0 );
+    size_t points = 0, counts = 0, filled = 0;
+    for ( size_t r=0; r<regions.size(); r++ ) {
+      const Region &R = regions[r];
+      for ( size_t b=0; b<R.blocks.size(); b++ ) {
+	for ( size_t lo=0; lo<R.blocks[b].n; lo+=PARTITIONBLOCK ) {
+	  const size_t hi = min ( R.blocks[b].n, lo + PARTITIONBLOCK );
+	  pieces.push_back ( Piece { r, b, lo, hi, points, counts } );
+	  points += hi - lo;
+	  counts += R.fresh.size();
+	  filled += hi - lo;
+	  if ( filled >= PARTITIONBLOCK ) { tasks.push_back ( pieces.size() ); filled = 0; }
+	}
+      }
+    }
+    if ( tasks.back() != pieces.size() ) tasks.push_back ( pieces.size() );
+    assign  .resize ( points );
+    side    .resize ( points );
+    place   .assign ( counts, 0 );
+    bestSide.assign ( counts, 0 );
+    bestId  .assign ( counts, NOPOINT );
+
+    // Each point goes to the first new face it sees
+    eachPiece ( [&] ( const Piece &T, size_t worker ) {
+	const Region   &R = regions[T.region];
+	const Block    &B = R.blocks[T.block];
+	const size_t    n = T.hi - T.lo;
+	float          *s = scratch[worker].data();
+	uint32_t       *a = &assign[T.points];
+	float          *v = &side  [T.points];
+	uint32_t       *c = &place [T.counts];
+	size_t          left = n;
+
+	fill ( a, a+n, NOPOINT );
+	for ( uint32_t k=0; k<R.fresh.size() && left; k++ ) {
+	  const uint32_t h = R.fresh[k];
+	  const float    plane[4] = { pool.nx()[h], pool.ny()[h], pool.nz()[h], pool.d()[h] };
+	  CompGeom::planeSide ( plane, B.x+T.lo, B.y+T.lo, B.z+T.lo, n, s );
+	  for ( size_t i=0; i<n; i++ ) {
+	    if ( a[i] != NOPOINT || s[i] < -bound ) continue;
+	    if ( s[i] <= bound ) {
+	      const auto          &tri = pool.mesh()[h];
+	      const CompGeom::Vec3 p   { B.x[T.lo+i], B.y[T.lo+i], B.z[T.lo+i] };
+	      if ( CompGeom::orient3DExact ( geom[tri[0]], geom[tri[1]], geom[tri[2]], p ) <= 0 ) continue;
+	    }
+	    a[i] = k;
+	    v[i] = s[i];
+	    c[k]++;
+	    left--;
+	  }
+	}
+      } );
+
+    // Each block's points go after those of the blocks before it
+    for ( size_t r=0, t=0; r<regions.size(); r++ ) {
+      const Region &R     = regions[r];
+      const size_t  first = t;
+      while ( t < pieces.size() && pieces[t].region == r ) t++;
+      for ( uint32_t k=0; k<R.fresh.size(); k++ ) {
+	uint32_t total = 0;
+	for ( size_t u=first; u<t; u++ ) {
+	  const uint32_t here = place[pieces[u].counts + k];
+	  place[pieces[u].counts + k] = total;
+	  total += here;
+	}
+	if ( total && spare.size() ) { outside[R.fresh[k]] = move ( spare.back() ); spare.pop_back(); }
+	outside[R.fresh[k]].resize ( total );
+      }
+    }
+
+    eachPiece ( [&] ( const Piece &T, size_t ) {
+	const Region   &R = regions[T.region];
+	const Block    &B = R.blocks[T.block];
+	const uint32_t *a = &assign[T.points];
+	const float    *v = &side  [T.points];
+	for ( size_t i=0; i<T.hi-T.lo; i++ ) {
+	  if ( a[i] == NOPOINT ) continue;
+	  const size_t k   = T.counts + a[i];
+	  Outside     &o   = outside[R.fresh[a[i]]];
+	  const size_t pos = place[k]++;
+	  o.x[pos]  = B.x[T.lo+i];
+	  o.y[pos]  = B.y[T.lo+i];
+	  o.z[pos]  = B.z[T.lo+i];
+	  o.id[pos] = B.at ( T.lo+i );
+	  if ( bestId[k] == NOPOINT || before ( o.id[pos], v[i], bestId[k], bestSide[k] ) ) {
+	    bestSide[k] = v[i];
+	    bestId  [k] = o.id[pos];
+	  }
+	}
+      } );
+
+    // The first of the blocks' first points, the first block's if several are equal
+    for ( size_t r=0, t=0; r<regions.size(); r++ ) {
+      const Region &R = regions[r];
+      vector < float > best ( R.fresh.size(), 0 );
+      for ( auto h : R.fresh ) apex[h] = NOPOINT;
+      for ( ; t<pieces.size() && pieces[t].region == r; t++ ) {
+	for ( uint32_t k=0; k<R.fresh.size(); k++ ) {
+	  const size_t i = pieces[t].counts + k;
+	  if ( bestId[i] == NOPOINT ) continue;
+	  if ( apex[R.fresh[k]] == NOPOINT || before ( bestId[i], bestSide[i], apex[R.fresh[k]], best[k] ) ) {
+	    best[k] = bestSide[i];
+	    apex[R.fresh[k]] = bestId[i];
+	  }
+	}
+      }
+    }
+  }
+
+  vector < vector < size_t > > HullRounds::run ( const uint32_t id[4] ) {
+    typedef CompGeom::HullMesh Mesh;
+    Mesh &mesh = pool.mesh();
+
+    const bool     flip  = CompGeom::orient3DExact ( geom[id[0]], geom[id[1]], geom[id[2]], geom[id[3]] ) > 0;
+    const uint32_t t0[3] = { id[0], flip ? id[2] : id[1], flip ? id[1] : id[2] };
+    pool.add ( t0[0], t0[1], t0[2], geom );
+    pool.add ( t0[0], t0[2], id[3], geom );
+    pool.add ( t0[2], t0[1], id[3], geom );
+    pool.add ( t0[1], t0[0], id[3], geom );
+    mesh.link ( 0, 9 );	// t0[0] t0[1]
+    mesh.link ( 1, 6 );	// t0[1] t0[2]
+    mesh.link ( 2, 3 );	// t0[2] t0[0]
+    mesh.link ( 4, 8 );	// t0[2] id3
+    mesh.link ( 5, 10 );	// id3 t0[0]
+    mesh.link ( 7, 11 );	// t0[1] id3
+    grow ( pool.size() );
+
+    // Every point is handed on to the first tetrahedron
+    vector < Region > taken ( 1 );
+    taken[0].fresh  = { 0, 1, 2, 3 };
+    taken[0].blocks = { Block { geom.axis ( 0 ), geom.axis ( 1 ), geom.axis ( 2 ), NULL, 0, geom.size() } };
+    partition ( taken );
+
+    vector < uint32_t > active;
+    for ( uint32_t f=0; f<4; f++ ) if ( apex[f] != NOPOINT ) active.push_back ( f );
+
+    vector < Region > regions;
+    while ( !active.empty() ) {
+      if ( rank ) sort ( active.begin(), active.end(), [&] ( uint32_t f, uint32_t g ) {
+	  return rank[apex[f]] < rank[apex[g]]; } );
+      for ( auto &m : stamp ) m.resize ( pool.size(), 0 );
+      regions.resize ( active.size() );
+      threads->run ( ( active.size() + REGIONBLOCK - 1 ) / REGIONBLOCK, [&] ( size_t t, size_t worker ) {
+	  for ( size_t i=t*REGIONBLOCK; i<min ( active.size(), (t+1)*REGIONBLOCK ); i++ )
+	    findRegion ( regions[i], active[i], worker );
+	} );
+
+      // Swapped rather than moved so both keep their memory
+      size_t n = 0;
+      for ( auto &R : regions ) {
+	if ( !take ( R ) ) continue;
+	if ( n == taken.size() ) taken.emplace_back();
+	swap ( taken[n++], R );
+      }
+      taken.resize ( n );
+
+      // Faces still waiting, then the new ones
+      for ( const auto &R : taken )
+	for ( auto f : R.visible ) apex[f] = NOPOINT;
+      vector < uint32_t > next;
+      for ( auto f : active ) if ( apex[f] != NOPOINT ) next.push_back ( f );
+      for ( const auto *list : { &taken, &regions } ) {
+	for ( const auto &R : *list ) {
+	  for ( auto f : R.visible ) claim[f] = FREE;
+	  for ( auto t : R.horizon ) claim[Mesh::face ( t )] = FREE;
+	}
+      }
+
+      for ( auto &R : taken ) apply ( R );
+      partition ( taken );
+      for ( auto &R : taken ) {
+	for ( auto h : R.fresh ) if ( apex[h] != NOPOINT ) next.push_back ( h );
+	for ( auto &o : R.orphans ) {
+	  o.resize ( 0 );
+	  spare.push_back ( move ( o ) );
+	}
+      }
+      active.swap ( next );
+    }
+
+    pool.compact();
+    vector < vector < size_t > > result;
+    for ( size_t f=0; f<mesh.size(); f++ ) {
+      result.push_back ( { mesh[f][0], mesh[f][1], mesh[f][2] } );
+    }
+    return result;
+  }
+}
+
+vector < vector < size_t > > CompGeom::hullRounds ( const CompGeom::Points<3> &geom, const uint32_t tet[4],
+						   const uint32_t *rank ) {
+  if ( geom.size() >= NOPOINT ) errorM ( "3D hull ids must fit in 32 bits" );
+  HullRounds H ( geom, rank );
+  return H.run ( tet );
+}
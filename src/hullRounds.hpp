@@ -0,0 +1,34 @@
+/******************************************************
+ * Name    : hullRounds.hpp
+ * Author  : Kevin Mooney
+ * Created : 17/10/26
+ * Updated :
+ *
+ * Description:
+ *   3D hull grown in rounds on the cpu threads, shared
+ *   by quickHull3D and parallelHull3D. In each round
+ *   every face with points outside it puts one forward
+ *   and those far enough apart are added together
+ *
+ * NOTES:
+ *   - The output doesn't depend on the number of
+ *     threads, see setNumThreads in parallel.hpp
+ *   - Triangles are anti-clockwise viewed from outside,
+ *     the same as insertion3D
+ ******************************************************/
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "points.hpp"
+
+namespace CompGeom {
+
+  // Hull of geom grown from the tetrahedron tet, which mustn't be flat.
+  // Each face puts forward the farthest point outside it if rank is NULL,
+  // otherwise the one of lowest rank[id]
+  std::vector < std::vector < size_t > > hullRounds ( const Points<3> &geom, const uint32_t tet[4],
+						      const uint32_t *rank = NULL );
+}
@@ -0,0 +1,104 @@
+/******************************************************
+ * Name    : hullWorkspace.cpp
+ * Author  : Kevin Mooney
+ * Created : 17/10/26
+ * Updated :
+ *
+ * Description:
+ *   Buffers shared by successive gHullSerial calls
+ *
+ * NOTES:
+ *   - The pba library keeps one global set of textures
+ *     on the card, so only one workspace at a time
+ *     should use the GPU engine
+ ******************************************************/
+
+#include <algorithm>
+
+#include "hullWorkspace.hpp"
+#include "parallel.hpp"
+#include "pba2D.h"
+
+#define CLEARBLOCK 65536	// Touched pixels worth clearing on several threads
+
+using namespace CompGeom;
+
+HullWorkspace::HullWorkspace ( size_t resolution, VoronoiEngine engine,
+			       const std::vector < Direction::Dir > &faces )
+  : _resolution{0}
+  , _engine    {engine}
+  , _faces     {faces}
+  , _gpuReady  {false}
+{
+  for ( auto &n : _nTouched ) n = 0;
+  if ( resolution ) prepare ( resolution, engine );
+}
+
+HullWorkspace::~HullWorkspace () {
+  releaseGPU();
+}
+
+void HullWorkspace::releaseGPU () {
+#ifndef PBA_CPU_ONLY
+  if ( _gpuReady ) pba2DDeinitialization();
+#endif
+  _gpuReady = false;
+}
+
+// Everything depends on the resolution, the engines also on the choice of engine
+void HullWorkspace::allocate () {
+  const size_t w    = _resolution;
+  const size_t area = w*w;
+
+  _box.reset    ( new BoundingBox ( w, _faces ) );
+  _voronois.clear();
+  for ( auto dir : Direction::allDirections() )
+    _voronois.emplace_back ( _box->hasFace ( dir ) ? w : 0 );
+  _input = Voronoi ( w );
+  std::fill ( _input.data(), _input.data() + 2*area, short(MARKER) );
+
+  for ( auto dir : Direction::allDirections() ) {
+    _touched [dir].assign ( _box->hasFace ( dir ) ? area : 0, 0 );
+    _nTouched[dir] = 0;
+  }
+
+  releaseGPU();
+  _pba.reset ( new PBA2DCpu ( _engine == PBA_CPU ? w : 0 ) );
+  _edt.reset ( new EDT2DCpu ( _engine == EDT_CPU ? w : 0 ) );
+#ifndef PBA_CPU_ONLY
+  if ( _engine == PBA_GPU ) {
+    pba2DInitialization ( w );
+    _gpuReady = true;
+  }
+#endif
+}
+
+void HullWorkspace::prepare ( size_t resolution, VoronoiEngine engine ) {
+  if ( resolution != _resolution || engine != _engine ) {
+    _resolution = resolution;
+    _engine     = engine;
+    allocate();
+  }
+  else reset();
+}
+
+void HullWorkspace::reset () {
+  const size_t w = _resolution;
+
+  // Small hulls touch too few pixels to be worth the threads
+  size_t total = 0;
+  for ( auto &n : _nTouched ) total += n;
+
+  parallelFor ( 6, [&] ( size_t d ) {
+      const Direction::Dir dir = Direction::Dir(d);
+      Tile &T = (*_box)[dir];
+
+      for ( size_t t=0; t<_nTouched[dir]; t++ ) {
+	const uint32_t p = _touched[dir][t];
+	T.clear ( p/w, p%w );
+      }
+      _nTouched[dir] = 0;
+    }, total < CLEARBLOCK ? 6 : 1 );
+  _keys.clear();
+  _workingSets.clear();
+}
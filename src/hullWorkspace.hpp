@@ -0,0 +1,122 @@
+/******************************************************
+ * Name    : hullWorkspace.hpp
+ * Author  : Kevin Mooney
+ * Created : 17/10/26
+ * Updated :
+ *
+ * Description:
+ *   Owns the buffers gHullSerial needs between calls,
+ *   the projection tiles, the Voronoi textures, the
+ *   Voronoi engine and the stars, so computing many
+ *   hulls of the same resolution doesn't allocate them
+ *   again
+ *
+ * NOTES:
+ *   - Only the pixels a hull reached are cleared by
+ *     reset(), the rest of the buffers are left alone
+ *   - Buffers are only reallocated when the resolution
+ *     or engine given to prepare() changes
+ *   - Not copyable, one workspace per thread computing
+ *     hulls
+ ******************************************************/
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "boundingBox.hpp"
+#include "directionEnums.hpp"
+#include "edt2DCpu.hpp"
+#include "geometryHelper.hpp"
+#include "pba2DCpu.hpp"
+#include "points.hpp"
+#include "star.hpp"
+#include "starSet.hpp"
+#include "voronoi.hpp"
+#include "workingSet.hpp"
+
+namespace CompGeom {
+
+  class HullWorkspace {
+  private:
+    size_t			       _resolution;
+    VoronoiEngine		       _engine;
+    std::vector < Direction::Dir >     _faces;
+    bool			       _gpuReady;
+
+    std::unique_ptr < BoundingBox >    _box;
+    std::vector < Voronoi >	       _voronois;  // One per face
+    Voronoi			       _input;	   // All MARKER between calls
+    std::vector < uint32_t >	       _touched[6];	     // Pixels reached on each face
+    std::atomic < size_t >	       _nTouched[6];
+    std::unique_ptr < PBA2DCpu >       _pba;
+    std::unique_ptr < EDT2DCpu >       _edt;
+    std::vector < size_t >	       _rowEdges;  // Offsets of each row's dual edges
+    std::vector < uint64_t >	       _keys;	   // Packed dual edges
+    std::vector < uint64_t >	       _keyScratch;
+    std::vector < size_t >	       _sortCounts;
+    WorkingSets			       _workingSets;
+    std::vector < StarArena >	       _arenas;	   // Stars each thread built
+    StarSet			       _stars;
+    SplayQueue			       _splayQueue;
+    std::vector < uint32_t >	       _triangles; // Ids of each triangle of the hull
+    std::vector < HullPlane >	       _planes;	   // Planes of the hull's triangles
+    std::vector < std::vector < OutsidePoint > > _found; // Points each block found outside
+    std::vector < OutsidePoint >	       _outside;
+    Points < 3 >		       _points;	   // Geometry input as Points
+
+    void allocate ();
+    void releaseGPU ();
+
+  public:
+    // A resolution of 0 leaves the buffers empty until the first prepare()
+    HullWorkspace ( size_t resolution = DEFAULT_RESOLUTION,
+		    VoronoiEngine engine = DEFAULT_VORONOI_ENGINE,
+		    const std::vector < Direction::Dir > &faces = Direction::allDirections() );
+    ~HullWorkspace ();
+
+    HullWorkspace ( const HullWorkspace & )            = delete;
+    HullWorkspace &operator= ( const HullWorkspace & ) = delete;
+
+    // Resizes the buffers if the resolution or engine changed, then resets
+    void prepare ( size_t resolution, VoronoiEngine engine );
+
+    // Clears the pixels reached by the last hull
+    void reset ();
+
+    size_t        resolution () const { return _resolution; }
+    VoronoiEngine engine     () const { return _engine;     }
+
+    BoundingBox			 &box     ()       { return *_box;     }
+    const BoundingBox		 &box     () const { return *_box;     }
+    std::vector < Voronoi >	 &voronois()       { return _voronois; }
+    const std::vector < Voronoi > &voronois() const { return _voronois; }
+    Voronoi			 &input   ()       { return _input;    }
+    PBA2DCpu			 &pba     ()       { return *_pba;     }
+    EDT2DCpu			 &edt     ()       { return *_edt;     }
+    std::vector < size_t >	 &rowEdges()       { return _rowEdges;   }
+    std::vector < uint64_t >	 &keys    ()       { return _keys;       }
+    std::vector < uint64_t >	 &keyScratch()     { return _keyScratch; }
+    std::vector < size_t >	 &sortCounts()     { return _sortCounts; }
+    WorkingSets			 &workingSets()    { return _workingSets; }
+    std::vector < StarArena >	 &arenas  ()       { return _arenas;     }
+    StarSet			 &stars   ()       { return _stars;      }
+    SplayQueue			 &splayQueue()     { return _splayQueue; }
+    std::vector < uint32_t >	 &triangles()      { return _triangles;  }
+    std::vector < HullPlane >	 &planes  ()       { return _planes;     }
+    std::vector < std::vector < OutsidePoint > > &found() { return _found; }
+    std::vector < OutsidePoint >	 &outside ()       { return _outside;    }
+    Points < 3 >		 &points  ()       { return _points;     }
+
+    // Records that a pixel was reached for the first time, thread safe
+    void touch ( Direction::Dir dir, uint32_t pixel ) {
+      _touched[dir][_nTouched[dir].fetch_add ( 1, std::memory_order_relaxed )] = pixel;
+    }
+
+    size_t          nTouched ( Direction::Dir dir ) const { return _nTouched[dir]; }
+    const uint32_t *touched  ( Direction::Dir dir ) const { return _touched[dir].data(); }
+  };
+}
@@ -2,23 +2,48 @@
  * Name    : convexHull3D.cpp
  * Author  : Kevin Mooney
  * Created : 25/07/16
- * Updated : 02/08/16
+ * Updated : 17/10/26
  *
  * Description:
  *
  * NOTES:
+ *   - The triangles are tested against each new point
+ *     with the batch predicates of predicates.hpp. Only
+ *     results within their error bound are worked out
+ *     again with orient3DExact
+ *   - The first tetrahedron is made from the first points
+ *     that aren't coincident, collinear or coplanar
+ *   - Integer points skip the batch and are tested with
+ *     the integer orient3DExact
+ *   - The hull is a HullMesh. The triangles a point sees
+ *     are found by walking out from the first one, the
+ *     half edges leading out of them are the horizon and
+ *     the new triangles are joined up along it
+ *   - Float faces are kept in a FacePool. Removed faces
+ *     leave their slot on a free list for the new ones
+ *     and the planes of every slot, empty or not, are
+ *     tested in one linear scan. A pool passed in is
+ *     reused between hulls
  ******************************************************/
 
 #include <algorithm>
-#include <list>
+#include <array>
+#include <cstdint>
 #include <limits>
 #include <string>
 #include <vector>
 
+#include "convexHull3D.hpp"
+#include "exactPredicates.hpp"
+#include "facePool.hpp"
 #include "geometry.hpp"
+#include "hullMesh.hpp"
+#include "insertion3D.hpp"
+#include "intPoints.hpp"
 #include "point.hpp"
+#include "points.hpp"
+#include "predicates.hpp"
 #include "triangle.hpp"
-#include "unorderedEdge.hpp"
 
 using namespace std;
 
@@ -26,130 +51,261 @@ using namespace std;
 /////////////////////////////  INSERTION 3D  /////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////////////////////
 
-// Helper function
-// Removes an element if it's already in the list, otherwise adds it.
-// list is O(n) search which is bad
-static void addPotentialEdge ( list<CompGeom::UnorderedEdge> &arr, size_t id0, size_t id1 ) {
-  const CompGeom::UnorderedEdge	E  = {id0, id1};
-  const auto			it = find (arr.begin(),arr.end(), E ); 
-  if ( it == arr.end() )
-    arr.insert ( it, E );
-  else
-    arr.erase  ( it );
-}
+// Faces of float points live in a FacePool, the planes of every slot are
+// tested against a point in one call to planesSide
+struct InsertionFaces {
+  CompGeom::FacePool &pool;
+  const float	      bound;	// Error of the planes, see planeSideErrorBound
+  const float	     *side;
 
-// As each triangle is oriented with some normal, all edges are entered
-// such that the vertices are ordered anti-clockwise when viewing triangle from 
-// the normal
-vector < vector < size_t > > insertion3D ( const CompGeom::Geometry &geom ) {
-  if ( geom.size()    < 4 ) errorM ( "3D hull must have at least 4 points" ); 
-  if ( geom.getDim() != 3 ) errorM ( "Insertion3D only works in 3 dimensions" );
+  InsertionFaces ( const CompGeom::Points<3> &geom, CompGeom::FacePool &pool )
+    : pool  { pool },
+      bound { CompGeom::planeSideErrorBound ( CompGeom::maxAbsCoord ( geom ) ) },
+      side  { NULL } {}
 
-  // Construct initial triangle
-  list < CompGeom::Triangle > T = { CompGeom::Triangle{ 0, 1, 2, geom } };
-  CompGeom::Triangle &	t0	= T.front();
+  CompGeom::HullMesh &mesh () { return pool.mesh(); }
 
-  // Next point can't be visible from initial triangle
-  // Potential problem if geom[3] is coplanar
-  if ( t0.isVisible ( geom[3] ) ) t0.invert();
+  uint32_t add ( size_t id0, size_t id1, size_t id2, const CompGeom::Points<3> &geom ) {
+    return pool.add ( uint32_t ( id0 ), uint32_t ( id1 ), uint32_t ( id2 ), geom );
+  }
 
-  // Construct hull of first 4 points being careful to enter edges in correct order
-  T.insert( T.end(), { t0[0], t0[2], 3, geom } );
-  T.insert( T.end(), { t0[2], t0[1], 3, geom } );
-  T.insert( T.end(), { t0[1], t0[0], 3, geom } );
-  
-  for ( size_t i=4; i<geom.size(); i++ ) {
-    list < CompGeom::UnorderedEdge > potential_edges;
-    for ( auto it = T.begin(); it != T.end(); it++ ) {
-      auto	&tri		   = *it;
-      if ( tri.isVisible( geom[i] ) ) { 
-	addPotentialEdge ( potential_edges, tri[0], tri[1] );
-	addPotentialEdge ( potential_edges, tri[1], tri[2] );
-	addPotentialEdge ( potential_edges, tri[2], tri[0] );
-	T.erase (it++); it--;
-      }
-    }
-    for ( auto edge : potential_edges ) {
-      T.insert ( T.end(), {i,edge.first, edge.second,geom} );
-    }
+  void remove  ( uint32_t f ) { pool.remove ( f ); }
+  void compact () { pool.compact(); }
+
+  // One batch test against all of them, which is the same sum as
+  // Triangle::isVisible. Only sides within the bound are looked at again
+  void see ( const CompGeom::Points<3> &geom, size_t i ) { side = pool.sides ( geom[i] ); }
+
+  bool visible ( const CompGeom::Points<3> &geom, uint32_t f, size_t i ) const {
+    if ( side[f] >  bound ) return true;
+    if ( side[f] < -bound ) return false;
+    const auto &tri = pool.mesh()[f];
+    return CompGeom::orient3DExact ( geom[tri[0]], geom[tri[1]], geom[tri[2]], geom[i] ) > 0;
   }
-  
-  vector < vector < size_t > > result;
-  for ( auto tri : T ) {
-    result.push_back ( {tri[0],tri[1],tri[2]} );
+
+  // The first slot point i sees, or the number of slots if it sees none.
+  // Empty slots are never visible
+  uint32_t firstVisible ( const CompGeom::Points<3> &geom, size_t i ) const {
+    const uint32_t n = uint32_t ( pool.size() );
+    for ( uint32_t f=0; f<n; f++ )
+      if ( side[f] >= -bound && visible ( geom, f, i ) ) return f;
+    return n;
   }
-  return result;
-} 
+};
 
-//////////////////////////////////////////////////////////////////////////////////////////
-/////////////////////////////  DEBUG VERSION  ////////////////////////////////////////////
-//////////////////////////////////////////////////////////////////////////////////////////
+// Integer points only keep the mesh, the exact test is cheap enough to make each time
+struct IntInsertionFaces {
+  CompGeom::HullMesh &hull;
 
-// As each triangle is oriented with some	normal, all edges are entered
-// such that the vertices are ordered anti-clockwise when viewing triangle from 
-// the normal
-vector < vector < size_t > > insertion3D ( const CompGeom::Geometry &geom, const std::string &filename ) {
-  if ( geom.size() < 4 ) errorM ( "3D hull must have at least 4 points" ); 
-    
-  // Construct initial triangle
-  list < CompGeom::Triangle > T = { { 0, 1, 2, geom } };
-  CompGeom::Triangle &	t0	= T.front();
-
-  // Next point can't be visible from initial triangle
-  // Potential problem if geom[3] is coplanar
-  if ( t0.isVisible ( geom[3] ) ) t0.invert();
-
-  // Debugging
-  geom.print3DGeom ( filename, geom.size()-2);
-  {				// Debugging
-    vector < vector < size_t > > result;
-    for ( auto tri : T ) {
-      result.push_back ( {tri[0],tri[1],tri[2]} );
-    }
-    geom.append3DHull( filename, result, 0);
+  IntInsertionFaces ( const CompGeom::IntPoints<3> &, CompGeom::HullMesh &mesh ) : hull { mesh } {}
+
+  CompGeom::HullMesh &mesh () { return hull; }
+
+  uint32_t add ( size_t id0, size_t id1, size_t id2, const CompGeom::IntPoints<3> & ) {
+    return hull.add ( uint32_t ( id0 ), uint32_t ( id1 ), uint32_t ( id2 ) );
   }
-  
-  // Construct hull of first 4 points being careful to enter edges in correct order
-  T.insert( T.end(), { t0[0], t0[2], 3, geom } );
-  T.insert( T.end(), { t0[2], t0[1], 3, geom } );
-  T.insert( T.end(), { t0[1], t0[0], 3, geom } );
-  
-  {				// Debugging
-    vector < vector < size_t > > result;
-    for ( auto tri : T ) {
-      result.push_back ( {tri[0],tri[1],tri[2]} );
-    }
-    geom.append3DHull( filename, result, 1);
+
+  void remove  ( uint32_t f ) { hull.remove ( f ); }
+  void compact () { hull.compact(); }
+  void see     ( const CompGeom::IntPoints<3> &, size_t ) {}
+
+  bool visible ( const CompGeom::IntPoints<3> &geom, uint32_t f, size_t i ) const {
+    if ( !hull.alive ( f ) ) return false;
+    const auto &tri = hull[f];
+    return CompGeom::orient3DExact ( geom[tri[0]], geom[tri[1]], geom[tri[2]], geom[i] ) > 0;
+  }
+
+  uint32_t firstVisible ( const CompGeom::IntPoints<3> &geom, size_t i ) const {
+    const uint32_t n = uint32_t ( hull.size() );
+    for ( uint32_t f=0; f<n; f++ )
+      if ( visible ( geom, f, i ) ) return f;
+    return n;
   }
-  
-  
-  for ( size_t i=4; i<geom.size(); i++ ) {
-    list < CompGeom::UnorderedEdge > potential_edges;
-    for ( auto it = T.begin(); it != T.end(); it++ ) {
-      auto	&tri		   = *it;
-      if ( tri.isVisible( geom[i] ) ) { 
-	addPotentialEdge ( potential_edges, tri[0], tri[1] );
-	addPotentialEdge ( potential_edges, tri[1], tri[2] );
-	addPotentialEdge ( potential_edges, tri[2], tri[0] );
-	T.erase (it++); it--;
+};
+
+// Buffers reused for every point added
+struct Cap {
+  vector < uint32_t > visible;	// Triangles the point sees
+  vector < char >     inside;	// By slot, set for the visible ones
+  vector < uint32_t > horizon;	// Half edges across the horizon from the visible triangles
+  vector < uint32_t > fresh;	// New triangles
+  vector < uint32_t > startAt;	// New triangle whose horizon edge starts at each id
+
+  explicit Cap ( size_t n ) : startAt ( n ) {}
+};
+
+// Replaces the triangles point i sees with a cone from i to their horizon
+template < typename Faces, typename Pts >
+static void addPoint ( const Pts &geom, size_t i, Faces &T, Cap &cap ) {
+  typedef CompGeom::HullMesh Mesh;
+  Mesh &mesh = T.mesh();
+  T.see ( geom, i );
+
+  const uint32_t f0 = T.firstVisible ( geom, i );
+  if ( f0 == mesh.size() ) return;
+
+  // The visible triangles are joined up, so a walk out from one finds them all
+  cap.inside.resize ( mesh.size() );
+  cap.visible.assign ( 1, f0 );
+  cap.inside[f0] = 1;
+  cap.horizon.clear();
+  for ( size_t v=0; v<cap.visible.size(); v++ ) {
+    const uint32_t f = cap.visible[v];
+    for ( uint32_t k=0; k<3; k++ ) {
+      const uint32_t g = Mesh::face ( mesh.twin ( Mesh::edge ( f, k ) ) );
+      if ( !cap.inside[g] && T.visible ( geom, g, i ) ) {
+	cap.inside[g] = 1;
+	cap.visible.push_back ( g );
       }
     }
-    for ( auto edge : potential_edges ) {
-      T.insert ( T.end(), {i,edge.first, edge.second,geom} );
-    }
-    // Debugging
-    {			      
-      vector < vector < size_t > > result;
-      for ( auto tri : T ) {
-	result.push_back ( {tri[0],tri[1],tri[2]} );
-      }
-      geom.append3DHull( filename, result, i-2);
+  }
+  for ( auto f : cap.visible ) {
+    for ( uint32_t k=0; k<3; k++ ) {
+      const uint32_t t = mesh.twin ( Mesh::edge ( f, k ) );
+      if ( !cap.inside[Mesh::face ( t )] ) cap.horizon.push_back ( t );
     }
   }
-  
+
+  // Nothing moves, so the horizon's half edges stay where they are and the
+  // new triangles take the visible ones' slots
+  for ( auto f : cap.visible ) {
+    cap.inside[f] = 0;
+    T.remove ( f );
+  }
+  cap.fresh.clear();
+  for ( auto t : cap.horizon ) {
+    const uint32_t a = mesh.target ( t ), b = mesh.origin ( t );
+    const uint32_t h = T.add ( a, b, i, geom );
+    mesh.link ( Mesh::edge ( h, 0 ), t );
+    cap.startAt[a] = h;
+    cap.fresh.push_back ( h );
+  }
+  for ( auto h : cap.fresh ) {
+    mesh.link ( Mesh::edge ( h, 1 ), Mesh::edge ( cap.startAt[mesh[h][1]], 2 ) );
+  }
+}
+
+// First index from start for which test is true
+template < typename Pts, typename Test >
+static size_t findFirst ( const Pts &geom, size_t start, Test test ) {
+  for ( size_t i=start; i<geom.size(); i++ )
+    if ( test ( geom[i] ) ) return i;
+  errorM ( "3D hull needs 4 points that aren't coplanar" );
+  return 0;
+}
+
+// Adds the points one at a time, writing each step to trace unless it is NULL
+// Faces is InsertionFaces for float points and IntInsertionFaces for integers,
+// the hull is left in its mesh with no gaps
+template < typename Faces, typename Pts >
+static vector < vector < size_t > > insertion3D ( const Pts &geom, CompGeom::ConvexHull3D *trace, Faces &T )
+{
+  typedef typename Pts::value_type Vec;
+  if ( geom.size()    < 4 ) errorM ( "3D hull must have at least 4 points" ); 
+
+  // The first tetrahedron, usually points 0 to 3
+  const Vec    p0  = geom[0];
+  const size_t id1 = findFirst ( geom, 1,     [&] ( const Vec &p ) {
+      return p.x != p0.x || p.y != p0.y || p.z != p0.z; } );
+  const size_t id2 = findFirst ( geom, id1+1, [&] ( const Vec &p ) {
+      return !CompGeom::collinearExact ( p0, geom[id1], p ); } );
+  const size_t id3 = findFirst ( geom, id2+1, [&] ( const Vec &p ) {
+      return CompGeom::orient3DExact ( p0, geom[id1], geom[id2], p ) != 0; } );
+
+  // Initial triangle, the next point can't be visible from it
+  const bool   flip = CompGeom::orient3DExact ( p0, geom[id1], geom[id2], geom[id3] ) > 0;
+  const size_t t0[3] = { 0, flip ? id2 : id1, flip ? id1 : id2 };
+
+  CompGeom::HullMesh &mesh = T.mesh();
+  auto step = [&] () {
+    if ( !trace ) return;
+    const auto live = mesh.triangles();
+    trace->update ( live.begin(), live.end() );
+  };
+  T.add ( t0[0], t0[1], t0[2], geom );
+  step();
+
+  // Construct hull of first 4 points being careful to enter edges in correct order
+  T.add ( t0[0], t0[2], id3, geom );
+  T.add ( t0[2], t0[1], id3, geom );
+  T.add ( t0[1], t0[0], id3, geom );
+  mesh.link ( 0, 9 );	// t0[0] t0[1]
+  mesh.link ( 1, 6 );	// t0[1] t0[2]
+  mesh.link ( 2, 3 );	// t0[2] t0[0]
+  mesh.link ( 4, 8 );	// t0[2] id3
+  mesh.link ( 5, 10 );	// id3 t0[0]
+  mesh.link ( 7, 11 );	// t0[1] id3
+  step();
+
+  Cap cap ( geom.size() );
+  for ( size_t i=1; i<geom.size(); i++ ) {
+    if ( i == id1 || i == id2 || i == id3 ) continue;
+    addPoint ( geom, i, T, cap );
+    step();
+  }
+
+  T.compact();
   vector < vector < size_t > > result;
-  for ( auto tri : T ) {
-    result.push_back ( {tri[0],tri[1],tri[2]} );
+  for ( size_t f=0; f<mesh.size(); f++ ) {
+    result.push_back ( {mesh[f][0],mesh[f][1],mesh[f][2]} );
   }
   return result;
-} 
+}
+
+// As each triangle is oriented with some normal, all edges are entered
+// such that the vertices are ordered anti-clockwise when viewing triangle from 
+// the normal
+vector < vector < size_t > > insertion3D ( const CompGeom::Geometry &geom ) {
+  if ( geom.getDim() != 3 ) errorM ( "Insertion3D only works in 3 dimensions" );
+  return insertion3D ( CompGeom::Points<3> ( geom ) );
+}
+
+vector < vector < size_t > > insertion3D ( const CompGeom::Points<3> &geom ) {
+  CompGeom::FacePool pool;
+  return insertion3D ( geom, pool );
+}
+
+vector < vector < size_t > > insertion3D ( const CompGeom::IntPoints<3> &geom ) {
+  CompGeom::HullMesh mesh;
+  return insertion3D ( geom, mesh );
+}
+
+vector < vector < size_t > > insertion3D ( const CompGeom::Geometry &geom, CompGeom::HullMesh &mesh ) {
+  if ( geom.getDim() != 3 ) errorM ( "Insertion3D only works in 3 dimensions" );
+  return insertion3D ( CompGeom::Points<3> ( geom ), mesh );
+}
+
+vector < vector < size_t > > insertion3D ( const CompGeom::Points<3> &geom, CompGeom::HullMesh &mesh ) {
+  CompGeom::FacePool pool;
+  const auto result = insertion3D ( geom, pool );
+  mesh = pool.mesh();
+  return result;
+}
+
+vector < vector < size_t > > insertion3D ( const CompGeom::IntPoints<3> &geom, CompGeom::HullMesh &mesh ) {
+  mesh.clear();
+  IntInsertionFaces T ( geom, mesh );
+  return insertion3D ( geom, NULL, T );
+}
+
+vector < vector < size_t > > insertion3D ( const CompGeom::Points<3> &geom, CompGeom::FacePool &pool ) {
+  pool.reset();
+  InsertionFaces T ( geom, pool );
+  return insertion3D ( geom, NULL, T );
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+/////////////////////////////  DEBUG VERSION  ////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+
+// Same as above, every step is written to filename
+vector < vector < size_t > > insertion3D ( const CompGeom::Geometry &points, const std::string &filename ) {
+  if ( points.size()    < 4 ) errorM ( "3D hull must have at least 4 points" );
+  if ( points.getDim() != 3 ) errorM ( "Insertion3D only works in 3 dimensions" );
+
+  CompGeom::ConvexHull3D trace ( points, filename );
+  CompGeom::FacePool     pool;
+  const CompGeom::Points<3> pts ( points );
+  InsertionFaces         T ( pts, pool );
+  return insertion3D ( pts, &trace, T );
+}
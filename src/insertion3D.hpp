@@ -2,7 +2,7 @@
  * Name    : insertion3D.hpp
  * Author  : Kevin Mooney
  * Created : 25/07/16
- * Updated :
+ * Updated : 17/10/26
  *
  * Description:
  *
@@ -13,12 +13,28 @@
 
 #include <string>
 
+#include "facePool.hpp"
 #include "geometry.hpp"
+#include "hullMesh.hpp"
+#include "intPoints.hpp"
+#include "points.hpp"
 
 // As each triangle is oriented with some normal, all edges are entered
 // such that the vertices are ordered anti-clockwise when viewing triangle from 
 // the normal
 std::vector < std::vector < size_t > > insertion3D ( const CompGeom::Geometry &geom ); 
+std::vector < std::vector < size_t > > insertion3D ( const CompGeom::Points<3> &geom );
+std::vector < std::vector < size_t > > insertion3D ( const CompGeom::IntPoints<3> &geom );
+
+// Same as above, mesh is set to the hull's triangles joined up by their edges
+std::vector < std::vector < size_t > > insertion3D ( const CompGeom::Geometry &geom, CompGeom::HullMesh &mesh );
+std::vector < std::vector < size_t > > insertion3D ( const CompGeom::Points<3> &geom, CompGeom::HullMesh &mesh );
+std::vector < std::vector < size_t > > insertion3D ( const CompGeom::IntPoints<3> &geom, CompGeom::HullMesh &mesh );
+
+// Same as above, the faces are built in pool, which keeps its memory for the
+// next hull. Its mesh holds the hull's triangles after
+std::vector < std::vector < size_t > > insertion3D ( const CompGeom::Points<3> &geom, CompGeom::FacePool &pool );
+
 std::vector < std::vector < size_t > > insertion3D ( const CompGeom::Geometry &geom, const std::string &filename ); 
 
 
@@ -0,0 +1,214 @@
+/******************************************************
+ * Name    : intPoints.hpp
+ * Author  : Kevin Mooney
+ * Created : 17/10/26
+ * Updated :
+ *
+ * Description:
+ *   Structure of arrays store of integer coordinates,
+ *   for quantized data the hulls can be found on with
+ *   exact integer determinants
+ *
+ * NOTES:
+ *   - Coordinates are below 2^INTBITS in size so the 2D
+ *     orientation fits in 64 bits and the 3D one in 128,
+ *     see exactPredicates.hpp
+ *   - quantize keeps integral input as it is and scales
+ *     anything else onto the integers, the coordinate of
+ *     a point is offset + scale * integer
+ ******************************************************/
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "alignedAllocator.hpp"
+#include "errorMessages.hpp"
+#include "geometry.hpp"
+
+#define INTBITS 26		// Most bits of a coordinate, not counting the sign
+
+namespace CompGeom {
+
+  // Plain integer coordinates of one point
+  struct IVec2 {
+    int32_t x, y;
+    int32_t operator[] ( size_t i ) const { return i == 0 ? x : y; }
+    size_t  size () const { return 2; }
+  };
+
+  struct IVec3 {
+    int32_t x, y, z;
+    int32_t operator[] ( size_t i ) const { return i == 0 ? x : i == 1 ? y : z; }
+    size_t  size () const { return 3; }
+  };
+
+  inline std::ostream &operator<< ( std::ostream &os, const IVec2 &p ) { return os << p.x << ' ' << p.y; }
+  inline std::ostream &operator<< ( std::ostream &os, const IVec3 &p ) { return os << p.x << ' ' << p.y << ' ' << p.z; }
+
+  template < size_t D > struct IVecOf       { typedef void  type; };
+  template <>           struct IVecOf < 2 > { typedef IVec2 type; };
+  template <>           struct IVecOf < 3 > { typedef IVec3 type; };
+
+  typedef std::vector < int32_t, AlignedAllocator < int32_t > > AlignedInts;
+
+  template < size_t D >
+  class IntPoints {
+  private:
+    AlignedInts _axes[D];
+    size_t      _size;
+    double      _scale;
+    double      _offset[D];
+
+  public:
+    typedef typename IVecOf < D >::type value_type;
+
+    IntPoints () : _size{0}, _scale{1} {
+      static_assert ( D == 2 || D == 3, "Integer points are 2D or 3D" );
+      for ( auto &o : _offset ) o = 0;
+    }
+
+    size_t size  () const { return _size; }
+    bool   empty () const { return _size == 0; }
+    size_t dim   () const { return D; }
+
+    int32_t       *axis ( size_t a )       { return _axes[a].data(); }
+    const int32_t *axis ( size_t a ) const { return _axes[a].data(); }
+
+    int32_t x ( size_t i ) const { return _axes[0][i]; }
+    int32_t y ( size_t i ) const { return _axes[1][i]; }
+    int32_t z ( size_t i ) const { static_assert ( D != 2, "2D points have no z" ); return _axes[2][i]; }
+    int32_t coord ( size_t i, size_t a ) const { return _axes[a][i]; }
+
+    value_type operator[] ( size_t i ) const { return get ( i, (value_type*)NULL ); }
+
+    void set ( size_t i, const value_type &p ) {
+      if ( !fits ( p ) ) errorM("Integer coordinates must be below 2^INTBITS");
+      for ( size_t a=0; a<D; a++ ) _axes[a][i] = p[a];
+    }
+    void push_back ( const value_type &p ) { resize ( _size+1 ); set ( _size-1, p ); }
+
+    void resize  ( size_t n ) { for ( auto &a : _axes ) a.resize  ( n ); _size = n; }
+    void reserve ( size_t n ) { for ( auto &a : _axes ) a.reserve ( n ); }
+
+    // Coordinate a of point i is offset(a) + scale() * coord(i,a)
+    double scale  () const           { return _scale; }
+    double offset ( size_t a ) const { return _offset[a]; }
+    void   setTransform ( double scale, const double offset[D] ) {
+      _scale = scale;
+      for ( size_t a=0; a<D; a++ ) _offset[a] = offset[a];
+    }
+
+    // The input was integral, the coordinates are the input's
+    bool exact () const {
+      if ( _scale != 1 ) return false;
+      for ( auto o : _offset ) if ( o != 0 ) return false;
+      return true;
+    }
+
+    // The points back in the input's coordinates, rounded to floats
+    Geometry geometry () const {
+      if ( _size == 0 ) return Geometry { D };
+      std::vector < Point > coords;
+      for ( size_t i=0; i<_size; i++ ) {
+	std::vector < float > p ( D );
+	for ( size_t a=0; a<D; a++ ) p[a] = float ( _offset[a] + _scale * _axes[a][i] );
+	coords.push_back ( Point ( p ) );
+      }
+      return Geometry ( coords );
+    }
+
+  private:
+    static bool fits ( const value_type &p ) {
+      for ( size_t a=0; a<D; a++ ) if ( std::abs ( int64_t ( p[a] ) ) >= ( int64_t(1) << INTBITS ) ) return false;
+      return true;
+    }
+
+    IVec2 get ( size_t i, IVec2* ) const { return { x(i), y(i) }; }
+    IVec3 get ( size_t i, IVec3* ) const { return { x(i), y(i), z(i) }; }
+  };
+
+  // Largest absolute value of any coordinate
+  template < size_t D >
+  int32_t maxAbsCoord ( const IntPoints < D > &pts ) {
+    int32_t m = 0;
+    for ( size_t a=0; a<D; a++ ) {
+      const int32_t *c = pts.axis ( a );
+      for ( size_t i=0; i<pts.size(); i++ ) m = std::max ( m, std::abs ( c[i] ) );
+    }
+    return m;
+  }
+
+  // n points where coordinate a of point i is coord(i,a). If they are all
+  // integers below 2^bits they are kept, otherwise their bounding box is
+  // scaled by the same amount on every axis onto [0,2^bits)
+  template < size_t D, typename Coord >
+  IntPoints < D > quantize ( size_t n, Coord coord, unsigned bits = INTBITS ) {
+    if ( bits > INTBITS ) errorM("Integer points have at most INTBITS bits");
+    const double limit = std::ldexp ( 1.0, bits );
+
+    bool   integral = true;
+    double lo[D], hi[D];
+    for ( size_t a=0; a<D; a++ ) { lo[a] = HUGE_VAL; hi[a] = -HUGE_VAL; }
+    for ( size_t i=0; i<n; i++ ) {
+      for ( size_t a=0; a<D; a++ ) {
+	const double c = coord ( i, a );
+	integral &= c == std::floor ( c ) && std::abs ( c ) < limit;
+	lo[a] = std::min ( lo[a], c );
+	hi[a] = std::max ( hi[a], c );
+      }
+    }
+
+    double scale = 1, offset[D] = {};
+    if ( !integral ) {
+      double range = 0;
+      for ( size_t a=0; a<D; a++ ) { range = std::max ( range, hi[a] - lo[a] ); offset[a] = lo[a]; }
+      if ( range > 0 ) scale = range / ( limit - 1 );
+    }
+
+    IntPoints < D > pts;
+    pts.setTransform ( scale, offset );
+    pts.resize ( n );
+    for ( size_t a=0; a<D; a++ ) {
+      int32_t *axis = pts.axis ( a );
+      for ( size_t i=0; i<n; i++ ) axis[i] = int32_t ( std::lround ( ( coord ( i, a ) - offset[a] ) / scale ) );
+    }
+    return pts;
+  }
+
+  template < size_t D >
+  IntPoints < D > quantize ( const Geometry &geom, unsigned bits = INTBITS ) {
+    if ( geom.getDim() != D ) errorM("Geometry dimension doesn't match the integer points");
+    return quantize < D > ( geom.size(), [&geom] ( size_t i, size_t a ) { return double ( geom[i][a] ); }, bits );
+  }
+
+  // Reads D coordinates a line from filename, the way Geometry::print writes
+  // them, and quantizes them. The coordinates are read as doubles so integers
+  // too big for a float are still kept exactly
+  template < size_t D >
+  IntPoints < D > loadIntPoints ( const std::string &filename, unsigned bits = INTBITS ) {
+    std::ifstream file ( filename );
+    if ( !file ) errorM("Couldn't open the points file");
+
+    std::vector < double > coords;
+    std::string            line;
+    while ( std::getline ( file, line ) ) {
+      std::istringstream ss ( line );
+      double c[D];
+      size_t a = 0;
+      while ( a < D && ss >> c[a] ) a++;
+      if ( a == 0 && ss.eof() ) continue;	// Blank line
+      if ( a != D ) errorM("Every line of the points file needs a coordinate per dimension");
+      coords.insert ( coords.end(), c, c+D );
+    }
+    return quantize < D > ( coords.size() / D, [&coords] ( size_t i, size_t a ) { return coords[i*D + a]; }, bits );
+  }
+}
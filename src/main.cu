@@ -20,11 +20,18 @@
 
 #include "convexHull2D.hpp"
 #include "insertion3D.hpp"
+#include "parallelHull3D.hpp"
+#include "quickHull3D.hpp"
+#include "randomizedHull3D.hpp"
 #include "gHull.cuh"
 #include "gHullSerial.hpp"
 #include "cudaHull.hpp"		// 2D convex hull on GPU
 #include "errorMessages.hpp"
 #include "geometry.hpp"
+#include "intPoints.hpp"
+#include "parallel.hpp"
+#include "points.hpp"
+#include "voronoi.hpp"
 #include "workingSet.hpp"
 #include "star.hpp"
 
@@ -32,7 +39,8 @@ using namespace std;
 using namespace std::chrono;
 
 // DEBUGGING //
-CompGeom::Star constructStar_h ( const CompGeom::WorkingSet & W, const CompGeom::Geometry &geom );
+CompGeom::Star constructStar_h ( const CompGeom::WorkingSetSpan & W, const CompGeom::Points<3> &pts,
+				 CompGeom::StarArena &arena );
 ///////////////
 
 
@@ -56,12 +64,22 @@ void printUsage() {
 			{""      ,"  - giftWrap    (2D)                                "},
 			{""      ,"  - cudaHull    (2D)                                "},
 			{""      ,"  - insertion   (3D)                                "},
+			{""      ,"  - randomized  (3D)                                "},
+			{""      ,"  - quickHull   (3D)                                "},
+			{""      ,"  - parallel    (3D)                                "},
 			{""      ,"  - gHullSerial (3D)                                "},
 			{""      ,"  - gHull       (3D) (cuda)                         "},
 			{""      ,"                                                    "},
 			{"-d arg","Set the dimension                                   "},
+			{"-e arg","Voronoi engine used by gHullSerial                  "},
+			{""      ,"Options are : pbaGPU, pbaCPU, edtCPU                "},
 			{"-h"    ,"Prints this help message and exits succesfully      "},
                         {"-f arg","Prints config to $arg                               "},
+                        {"-i"    ,"Runs the cpu algorithms on integer coordinates      "},
+                        {"-l arg","Loads the points from $arg, one per line            "},
+                        {""      ,"Integral input is kept exact, the rest quantized    "},
+                        {"-j arg","Number of threads for cpu algorithms (0 is all)     "},
+                        {"-r arg","Projection resolution of the gHulls (0 is adaptive) "},
                         {"-t"    ,"Prints the time taken by each function              "}};
   printf("Usage: ./%s [options] ...\n",__FILE__);
   printf("Options:\n"                          );
@@ -87,13 +105,17 @@ int main(int argc, char *argv[]) {
   // Set defaults
   string algorithms    = "giftWrap";
   string filename      = "";
+  string points_file   = "";
   bool time_func_calls = 0;
+  bool integer         = 0;
   size_t dim           = 2;
   size_t n_points      = 10;
+  VoronoiEngine engine = DEFAULT_VORONOI_ENGINE;
+  size_t resolution    = DEFAULT_RESOLUTION;
  
   // Parse command line
   int option;
-  while ((option = getopt (argc, argv, "a:d:hf:n:t")) != -1) {
+  while ((option = getopt (argc, argv, "a:d:e:hf:il:j:n:r:t")) != -1) {
     switch(option) {
     case 'a':
       algorithms = optarg;
@@ -101,15 +123,30 @@ int main(int argc, char *argv[]) {
     case 'd':
       dim        = atoi(optarg);
       break;
+    case 'e':
+      engine     = voronoiEngine(optarg);
+      break;
     case 'h':
       printUsage();
       return EXIT_SUCCESS;
     case 'f':
       filename   = optarg;
       break;
+    case 'i':
+      integer    = 1;
+      break;
+    case 'l':
+      points_file = optarg;
+      break;
+    case 'j':
+      CompGeom::setNumThreads(atol(optarg));
+      break;
     case 'n':
       n_points   = atol(optarg);
       break;
+    case 'r':
+      resolution = atol(optarg);
+      break;
     case 't':
       time_func_calls = 1;
       break;
@@ -119,8 +156,24 @@ int main(int argc, char *argv[]) {
     }
   }
 
-  CompGeom::Geometry geom{dim};
-  geom.addRandom(n_points);
+  if ( ( points_file != "" || integer ) && dim != 2 && dim != 3 ) {
+    errorM("Integer and loaded points are 2D or 3D");
+  }
+
+  // Loaded points are read straight into integers, so nothing is lost
+  // to floats in integer mode
+  CompGeom::IntPoints<2> ints2;
+  CompGeom::IntPoints<3> ints3;
+  if ( points_file != "" && dim == 2 ) ints2 = CompGeom::loadIntPoints<2>(points_file);
+  if ( points_file != "" && dim == 3 ) ints3 = CompGeom::loadIntPoints<3>(points_file);
+
+  CompGeom::Geometry geom = points_file == "" ? CompGeom::Geometry{dim}
+                          : dim == 2          ? ints2.geometry() : ints3.geometry();
+  if ( points_file == "" ) {
+    geom.addRandom(n_points);
+    if ( integer && dim == 2 ) ints2 = CompGeom::quantize<2>(geom);
+    if ( integer && dim == 3 ) ints3 = CompGeom::quantize<3>(geom);
+  }
 
   std::istringstream ss(algorithms);
   std::string token;
@@ -129,7 +182,13 @@ int main(int argc, char *argv[]) {
     if ( token == "insertion" ) {
 
       // else if is easier to read than nested if statements 
-      if ( filename == "" && time_func_calls ) {
+      if ( integer && time_func_calls ) {
+	timer ( insertion3D(ints3) );
+      }
+      else if ( integer ) {
+	insertion3D(ints3);
+      }
+      else if ( filename == "" && time_func_calls ) {
 	timer ( insertion3D(geom) );
       }    
       else if ( filename == "" ) {
@@ -142,23 +201,68 @@ int main(int argc, char *argv[]) {
 	insertion3D(geom,filename);
     }
 
+    else if ( token == "randomized" ) {
+      if ( time_func_calls ) {
+	timer ( randomizedHull3D(geom) );
+      }
+      else randomizedHull3D(geom);
+    }
+
+    else if ( token == "quickHull" ) {
+      if ( time_func_calls ) {
+	timer ( quickHull3D(geom) );
+      }
+      else quickHull3D(geom);
+    }
+
+    else if ( token == "parallel" ) {
+      if ( time_func_calls ) {
+	timer ( parallelHull3D(geom) );
+      }
+      else parallelHull3D(geom);
+    }
+
     else if ( token == "gHullSerial" ) {
       if ( time_func_calls ) {
-	timer ( gHullSerial(geom) );
+	CompGeom::HullWorkspace ws ( 0, engine );
+	GHullTimings t;
+	if ( integer ) {
+	  timer ( gHullSerial(ints3,ws,engine,resolution,&t) );
+	}
+	else {
+	  timer ( gHullSerial(geom,ws,engine,resolution,&t) );
+	}
+	printf("%-20s: %lf\n","  projection"  , t.projection  );
+	printf("%-20s: %lf\n","  voronoi"     , t.voronoi     );
+	printf("%-20s: %lf\n","  working sets", t.workingSets );
+	printf("%-20s: %lf\n","  stars"       , t.stars       );
+	printf("%-20s: %lf\n","  splaying"    , t.splaying    );
+      }
+      else if ( integer ) {
+	CompGeom::HullWorkspace ws ( 0, engine );
+	gHullSerial(ints3,ws,engine,resolution);
       }
       else 
-	gHullSerial(geom);
+	gHullSerial(geom,engine,resolution);
     }    
 
     else if ( token == "giftWrap" ) {
-      if ( time_func_calls ) {
+      if ( integer && time_func_calls ) {
+	timer ( giftWrap(ints2) );
+      }
+      else if ( integer ) giftWrap(ints2) ;
+      else if ( time_func_calls ) {
 	timer ( giftWrap(geom) );
       }
       else giftWrap(geom) ;
     }    
 
     else if ( token == "grahamScan" ) {
-      if ( time_func_calls ) {
+      if ( integer && time_func_calls ) {
+	timer ( grahamScan(ints2) );
+      }
+      else if ( integer ) grahamScan ( ints2 );
+      else if ( time_func_calls ) {
 	timer ( grahamScan(geom) );
       }
       else grahamScan ( geom );
@@ -171,9 +275,9 @@ int main(int argc, char *argv[]) {
     }    
     else if ( token == "gHull" ) {
       if ( time_func_calls ) {
-      	timer ( gHull(geom) );
+      	timer ( gHull(geom,resolution) );
       }
-      else gHull ( geom );
+      else gHull ( geom,resolution );
     }        
 
     else {
@@ -0,0 +1,59 @@
+/******************************************************
+ * Name    : parallel.hpp
+ * Author  : Kevin Mooney
+ * Created : 17/10/26
+ * Updated :
+ *
+ * Description:
+ *   Small helpers for splitting loops across cpu threads
+ *
+ * NOTES:
+ *   - The number of threads is global, 0 means use
+ *     every hardware thread
+ *   - parallelFor runs on the threads of threadPool(),
+ *     nothing is started or allocated per call. An
+ *     exception thrown by f is rethrown once every
+ *     thread has stopped
+ ******************************************************/
+
+#pragma once
+
+#include <algorithm>
+#include <memory>
+#include <thread>
+
+#include "threadPool.hpp"
+
+namespace CompGeom {
+
+  inline size_t &threadSetting() { static size_t n = 0; return n; }
+
+  // Sets the number of threads used by the cpu algorithms
+  inline void setNumThreads ( size_t n ) { threadSetting() = n; }
+
+  inline size_t numThreads () {
+    size_t n = threadSetting();
+    if ( n == 0 ) n = std::thread::hardware_concurrency();
+    return std::max<size_t> ( n, 1 );
+  }
+
+  // Calls f(i) for every i in [0,n)
+  // Each thread is given one contiguous chunk of the range, of at least
+  // grain iterations. Shorter ranges, and calls from a task already on a
+  // pool, run on the calling thread
+  template < typename Func >
+  void parallelFor ( size_t n, Func f, size_t grain = 1 ) {
+    const size_t nt = std::min ( numThreads(), n / std::max < size_t > ( grain, 1 ) );
+    if ( nt <= 1 || ThreadPool::working() ) {
+      for ( size_t i=0; i<n; i++ ) f(i);
+      return;
+    }
+
+    // One capture keeps the job inside std::function, unallocated
+    struct Range { Func &f; size_t n, nt; } range { f, n, nt };
+    const std::shared_ptr < ThreadPool > pool = threadPool();
+    pool->run ( nt, [&range] ( size_t t, size_t ) {
+	for ( size_t i = t*range.n/range.nt; i < (t+1)*range.n/range.nt; i++ ) range.f(i);
+      } );
+  }
+}
@@ -0,0 +1,38 @@
+/******************************************************
+ * Name    : parallelHull3D.cpp
+ * Author  : Kevin Mooney
+ * Created : 17/10/26
+ * Updated :
+ *
+ * Description:
+ *
+ * NOTES:
+ *   - Each face puts forward the lowest ranked point
+ *     outside it, the only one of them that can be next.
+ *     In a round a point is added unless its cap touches
+ *     that of a point before it, added or not
+ *   - See hullRounds.cpp for the rounds themselves
+ ******************************************************/
+
+#include <cstdint>
+#include <vector>
+
+#include "errorMessages.hpp"
+#include "hullRounds.hpp"
+#include "parallelHull3D.hpp"
+
+using namespace std;
+
+vector < vector < size_t > > parallelHull3D ( const CompGeom::Geometry &geom, unsigned seed ) {
+  if ( geom.getDim() != 3 ) errorM ( "parallelHull3D only works in 3 dimensions" );
+  return parallelHull3D ( CompGeom::Points<3> ( geom ), seed );
+}
+
+vector < vector < size_t > > parallelHull3D ( const CompGeom::Points<3> &geom, unsigned seed ) {
+  if ( geom.size() < 4 ) errorM ( "3D hull must have at least 4 points" );
+
+  const vector < uint32_t > order = randomOrder ( geom, seed );
+  vector < uint32_t >       rank ( geom.size() );
+  for ( uint32_t r=0; r<order.size(); r++ ) rank[order[r]] = r;
+  return CompGeom::hullRounds ( geom, order.data(), rank.data() );
+}
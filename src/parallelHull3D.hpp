@@ -0,0 +1,35 @@
+/******************************************************
+ * Name    : parallelHull3D.hpp
+ * Author  : Kevin Mooney
+ * Created : 17/10/26
+ * Updated :
+ *
+ * Description:
+ *   Randomized incremental 3D hull on the cpu threads.
+ *   The points are added in the random order of
+ *   randomizedHull3D, in rounds of points whose caps
+ *   don't touch
+ *
+ * NOTES:
+ *   - G. E. Blelloch, Y. Gu, J. Shun and Y. Sun,
+ *     "Parallelism in randomized incremental algorithms"
+ *   - For points in general position the hull is the
+ *     same as randomizedHull3D's with the same seed, flat
+ *     faces may be split differently. It doesn't depend
+ *     on the number of threads
+ *   - Triangles are anti-clockwise viewed from outside,
+ *     the same as insertion3D
+ ******************************************************/
+
+#pragma once
+
+#include <vector>
+
+#include "geometry.hpp"
+#include "points.hpp"
+#include "randomizedHull3D.hpp"
+
+std::vector < std::vector < size_t > > parallelHull3D ( const CompGeom::Geometry &geom,
+							unsigned seed = DEFAULT_HULL_SEED );
+std::vector < std::vector < size_t > > parallelHull3D ( const CompGeom::Points<3> &geom,
+							unsigned seed = DEFAULT_HULL_SEED );
@@ -0,0 +1,319 @@
+/******************************************************
+ * Name    : pba2DCpu.cpp
+ * Author  : Kevin Mooney
+ * Created : 17/10/26
+ * Updated :
+ *
+ * Description:
+ *   Cpu port of the Parallel Banding Algorithm, the
+ *   kernels in lib/pba2DKernel.h are followed closely
+ *
+ * NOTES:
+ *   - Phase 1 works down the columns (x,y), phases 2 and 3
+ *     work along the rows. In a row the position of a site
+ *     is its column and its perpendicular coordinate is
+ *     its row.
+ *   - Work is split over bands as well as columns/rows, so
+ *     the band parameters set the granularity of the tasks
+ ******************************************************/
+
+#include <algorithm>
+#include <cstdlib>
+
+#include "errorMessages.hpp"
+#include "parallel.hpp"
+#include "pba2D.h"
+#include "pba2DCpu.hpp"
+
+#define COLBLOCK 64		// Columns given to a single phase 1 task
+
+using namespace CompGeom;
+
+// Same as TOID in pba2DKernel.h
+static inline int toID ( int x, int y, int size ) { return y*size + x; }
+
+// Position along the row where the bisector of two sites crosses row x0
+// Sites are given as (perpendicular, position), requires y1 < y2
+static inline float interpoint ( int x1, int y1, int x2, int y2, int x0 ) {
+  float xM = float(x1 + x2) / 2.0f;
+  float yM = float(y1 + y2) / 2.0f;
+  float nx = x2 - x1;
+  float ny = y2 - y1;
+
+  return yM + nx * (xM - x0) / ny;
+}
+
+PBA2DCpu::PBA2DCpu ( int textureSize )
+  : _size  {textureSize}
+  , _colour(textureSize*textureSize)
+  , _links {}
+  , _prev  (textureSize*textureSize)
+  , _next  (textureSize*textureSize)
+  , _head  {}
+  , _tail  {}
+{}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+/////////////////////////////  PHASE 1  //////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+
+// kernelFloodDown and kernelFloodUp for the columns [x0,x1)
+void PBA2DCpu::floodBand ( const short *input, int band, int bandSize, int x0, int x1 ) {
+  const int   N      = _size;
+  const int   top    = band*bandSize;
+  const int   bottom = top + bandSize - 1;
+  const Pixel marker = { MARKER, MARKER };
+  Pixel       last[COLBLOCK];
+
+  std::fill ( last, last + COLBLOCK, marker );
+  for ( int y = top; y <= bottom; y++ ) {
+    for ( int x = x0; x < x1; x++ ) {
+      const int id = toID(x,y,N);
+      if ( input[2*id] != MARKER ) {
+	last[x-x0].x = input[2*id  ];
+	last[x-x0].y = input[2*id+1];
+      }
+      _colour[id] = last[x-x0];
+    }
+  }
+
+  std::fill ( last, last + COLBLOCK, marker );
+  for ( int y = bottom; y >= top; y-- ) {
+    for ( int x = x0; x < x1; x++ ) {
+      const int id = toID(x,y,N);
+      if ( std::abs(_colour[id].y - y) < std::abs(last[x-x0].y - y) )
+	last[x-x0] = _colour[id];
+      _colour[id] = last[x-x0];
+    }
+  }
+}
+
+// kernelPropagateInterband
+// Links are written to _links rather than back into the input texture
+void PBA2DCpu::propagateBand ( int band, int nBands, int bandSize, int x0, int x1 ) {
+  const int   N          = _size;
+  const int   top        = band*bandSize;
+  const int   bottom     = top + bandSize - 1;
+  const Pixel marker     = { MARKER, MARKER };
+  Pixel      *topLink    = &_links[(2*band  )*N];
+  Pixel      *bottomLink = &_links[(2*band+1)*N];
+
+  for ( int x = x0; x < x1; x++ ) {
+    topLink[x] = bottomLink[x] = marker;
+
+    // Top row, look backward
+    int myDist = std::abs ( _colour[toID(x,top,N)].y - top );
+    for ( int b = band-1; b >= 0; b-- ) {
+      const Pixel &p = _colour[toID(x,(b+1)*bandSize-1,N)];
+      if ( p.x != MARKER ) {
+	if ( std::abs(p.y - top) < myDist ) topLink[x] = p;
+	break;
+      }
+    }
+
+    // Last row, look downward
+    myDist = std::abs ( _colour[toID(x,bottom,N)].y - bottom );
+    for ( int b = band+1; b < nBands; b++ ) {
+      const Pixel &p = _colour[toID(x,b*bandSize,N)];
+      if ( p.x != MARKER ) {
+	if ( std::abs(p.y - bottom) < myDist ) bottomLink[x] = p;
+	break;
+      }
+    }
+  }
+}
+
+// kernelUpdateVertical
+void PBA2DCpu::updateBand ( int band, int bandSize, int x0, int x1 ) {
+  const int    N          = _size;
+  const int    top        = band*bandSize;
+  const Pixel *topLink    = &_links[(2*band  )*N];
+  const Pixel *bottomLink = &_links[(2*band+1)*N];
+
+  for ( int y = top; y < top + bandSize; y++ ) {
+    for ( int x = x0; x < x1; x++ ) {
+      const int id     = toID(x,y,N);
+      Pixel     pixel  = _colour[id];
+      int       myDist = std::abs ( pixel.y - y );
+      int       dist;
+
+      dist = std::abs ( topLink[x].y - y );
+      if ( dist < myDist ) { myDist = dist; pixel = topLink[x]; }
+
+      dist = std::abs ( bottomLink[x].y - y );
+      if ( dist < myDist ) pixel = bottomLink[x];
+
+      _colour[id] = pixel;
+    }
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+/////////////////////////////  PHASE 2  //////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+
+// kernelProximatePoints and kernelCreateForwardPointers for one band of row y
+void PBA2DCpu::proximatePoints ( int y, int band, int bandSize, int slot ) {
+  const int    N    = _size;
+  const Pixel *row  = &_colour[toID(0,y,N)];
+  short       *prev = &_prev  [toID(0,y,N)];
+  short       *next = &_next  [toID(0,y,N)];
+  int          last = -1;
+
+  for ( int x = band*bandSize; x < (band+1)*bandSize; x++ ) {
+    if ( row[x].x == MARKER ) continue;
+
+    // Pop sites that are no longer closest anywhere in the row
+    while ( last >= 0 && prev[last] >= 0 ) {
+      const int   a  = prev[last];
+      const float i1 = interpoint ( row[a   ].y, a   , row[last].y, last, y );
+      const float i2 = interpoint ( row[last].y, last, row[x   ].y, x   , y );
+      if ( i1 < i2 ) break;
+      last = a;
+    }
+    prev[x] = last;
+    last    = x;
+  }
+
+  int first = -1;
+  for ( int s = last; s >= 0; s = prev[s] ) {
+    next[s] = first;
+    first   = s;
+  }
+  _head[slot] = first;
+  _tail[slot] = last;
+}
+
+// kernelMergeBands, the merged band is stored in slot1
+void PBA2DCpu::mergeBands ( int y, int slot1, int slot2 ) {
+  const int    N    = _size;
+  const Pixel *row  = &_colour[toID(0,y,N)];
+  short       *prev = &_prev  [toID(0,y,N)];
+  short       *next = &_next  [toID(0,y,N)];
+
+  int last    = _tail[slot1];
+  int current = _head[slot2];
+
+  // Count the number of items in the second band that survive so far.
+  // Once it reaches 2, the rest of the second band is unchanged.
+  int top = 0;
+  while ( top < 2 && current >= 0 ) {
+    while ( last >= 0 && prev[last] >= 0 ) {
+      const int   a  = prev[last];
+      const float i1 = interpoint ( row[a   ].y, a   , row[last   ].y, last   , y );
+      const float i2 = interpoint ( row[last].y, last, row[current].y, current, y );
+      if ( i1 < i2 ) break;
+      last = a;
+      top--;
+    }
+
+    const int following = next[current];
+    prev[current] = last;
+    if ( last >= 0 ) next[last] = current;
+
+    last    = current;
+    current = following;
+    top     = std::max ( 1, top + 1 );
+  }
+
+  if ( _head[slot1] < 0 ) _head[slot1] = _head[slot2];
+  if ( _tail[slot2] >= 0 ) _tail[slot1] = _tail[slot2];
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+/////////////////////////////  PHASE 3  //////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+
+// kernelColor for the pixels [x0,x1) of row y
+// Each segment starts from the tail of the row, so segments are independent
+void PBA2DCpu::colour ( short *output, int y, int x0, int x1, int tail ) const {
+  const int    N    = _size;
+  const Pixel *row  = &_colour[toID(0,y,N)];
+  const short *prev = &_prev  [toID(0,y,N)];
+  short       *out  = &output [2*toID(0,y,N)];
+
+  // No sites anywhere in the texture
+  if ( tail < 0 ) {
+    std::fill ( out + 2*x0, out + 2*x1, short(MARKER) );
+    return;
+  }
+
+  int last = tail;
+  for ( int x = x1-1; x >= x0; x-- ) {
+    int dx   = last - x;
+    int dy   = row[last].y - y;
+    int best = dx*dx + dy*dy;
+
+    while ( prev[last] >= 0 ) {
+      const int a    = prev[last];
+      dx             = a - x;
+      dy             = row[a].y - y;
+      const int dist = dx*dx + dy*dy;
+      if ( dist > best ) break;
+      best = dist;
+      last = a;
+    }
+
+    out[2*x  ] = last;
+    out[2*x+1] = row[last].y;
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+/////////////////////////////  VORONOI DIAGRAM  //////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+
+void PBA2DCpu::voronoiDiagram ( const short *input, short *output,
+				int phase1Band, int phase2Band, int phase3Band )
+{
+  const int N = _size;
+  if ( N % phase1Band || N % phase2Band || N % phase3Band )
+    errorM("PBA band parameters must divide the texture size");
+  if ( phase2Band & (phase2Band-1) )
+    errorM("PBA phase 2 band must be a power of 2");
+
+  // Phase 1, flood the columns in their own bands then pass
+  // information between bands
+  const int bs1     = N / phase1Band;
+  const int nBlocks = (N + COLBLOCK - 1) / COLBLOCK;
+  _links.resize ( 2*phase1Band*N );
+
+  parallelFor ( phase1Band*nBlocks, [&] ( size_t t ) {
+      const int x0 = (t % nBlocks) * COLBLOCK;
+      floodBand     ( input, t / nBlocks, bs1, x0, std::min ( N, x0+COLBLOCK ) );
+    } );
+  parallelFor ( phase1Band*nBlocks, [&] ( size_t t ) {
+      const int x0 = (t % nBlocks) * COLBLOCK;
+      propagateBand ( t / nBlocks, phase1Band, bs1, x0, std::min ( N, x0+COLBLOCK ) );
+    } );
+  parallelFor ( phase1Band*nBlocks, [&] ( size_t t ) {
+      const int x0 = (t % nBlocks) * COLBLOCK;
+      updateBand    ( t / nBlocks, bs1, x0, std::min ( N, x0+COLBLOCK ) );
+    } );
+
+  // Phase 2, proximate points in each band of each row then
+  // repeatedly merge pairs of bands
+  const int bs2 = N / phase2Band;
+  _head.resize ( N*phase2Band );
+  _tail.resize ( N*phase2Band );
+
+  parallelFor ( N*phase2Band, [&] ( size_t t ) {
+      const int y = t / phase2Band, band = t % phase2Band;
+      proximatePoints ( y, band, bs2, y*phase2Band + band );
+    } );
+  for ( int noBand = phase2Band; noBand > 1; noBand /= 2 ) {
+    const int step = phase2Band / noBand; // slots covered by one band
+    const int half = noBand / 2;
+    parallelFor ( N*half, [&] ( size_t t ) {
+	const int y = t / half, band = 2*(t % half);
+	mergeBands ( y, y*phase2Band + band*step, y*phase2Band + (band+1)*step );
+      } );
+  }
+
+  // Phase 3, colour the rows
+  const int bs3 = N / phase3Band;
+  parallelFor ( N*phase3Band, [&] ( size_t t ) {
+      const int y = t / phase3Band, seg = t % phase3Band;
+      colour ( output, y, seg*bs3, (seg+1)*bs3, _tail[y*phase2Band] );
+    } );
+}
@@ -0,0 +1,55 @@
+/******************************************************
+ * Name    : pba2DCpu.hpp
+ * Author  : Kevin Mooney
+ * Created : 17/10/26
+ * Updated :
+ *
+ * Description:
+ *   Port of the Parallel Banding Algorithm (lib/pba2DHost.cu)
+ *   to cpu threads. Takes the same input and gives the
+ *   same output as pba2DVoronoiDiagram, see lib/pba2D.h
+ *
+ * NOTES:
+ *   - The transposes of the cuda version are only there
+ *     for coalescing, here phases 2 and 3 run along the
+ *     rows directly
+ *   - Band parameters must divide textureSize and
+ *     phase2Band must be a power of 2
+ ******************************************************/
+
+#pragma once
+
+#include <vector>
+
+namespace CompGeom {
+
+  class PBA2DCpu {
+  private:
+    struct Pixel { short x, y; };
+
+    int _size;
+    std::vector < Pixel > _colour; // Nearest site found so far
+    std::vector < Pixel > _links;  // Band boundary links in phase 1
+    std::vector < short > _prev;   // Backward pointers of the phase 2 stacks
+    std::vector < short > _next;   // Forward pointers of the phase 2 stacks
+    std::vector < short > _head;   // First stack element of each row band
+    std::vector < short > _tail;   // Last stack element of each row band
+
+    void floodBand       ( const short *input, int band, int bandSize, int x0, int x1 );
+    void propagateBand   ( int band, int nBands, int bandSize, int x0, int x1 );
+    void updateBand      ( int band, int bandSize, int x0, int x1 );
+    void proximatePoints ( int y, int band, int bandSize, int slot );
+    void mergeBands      ( int y, int slot1, int slot2 );
+    void colour          ( short *output, int y, int x0, int x1, int tail ) const;
+
+  public:
+    // textureSize is the width (and height) of the texture
+    PBA2DCpu ( int textureSize );
+
+    int size() const { return _size; }
+
+    // Same arguments as pba2DVoronoiDiagram
+    void voronoiDiagram ( const short *input, short *output,
+			  int phase1Band, int phase2Band, int phase3Band );
+  };
+}
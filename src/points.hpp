@@ -0,0 +1,145 @@
+/******************************************************
+ * Name    : points.hpp
+ * Author  : Kevin Mooney
+ * Created : 17/10/26
+ * Updated :
+ *
+ * Description:
+ *   Structure of arrays store of a geometry, one aligned
+ *   array per axis like Points in gHull.cu
+ *
+ * NOTES:
+ *   - The dimension is a template parameter, 2 and 3
+ *     return Vec2 and Vec3 from operator[]. DYNAMICDIM
+ *     takes the dimension at run time and only has the
+ *     per axis accessors
+ *   - Made from a Geometry once at the start of an
+ *     algorithm, nothing is allocated per point after
+ ******************************************************/
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <ostream>
+#include <vector>
+
+#include "alignedAllocator.hpp"
+#include "errorMessages.hpp"
+#include "geometry.hpp"
+
+#define DYNAMICDIM 0		// Dimension only known at run time
+
+namespace CompGeom {
+
+  // Plain coordinates of one point, float2 and float3 in cuda
+  struct Vec2 {
+    float x, y;
+    float  operator[] ( size_t i ) const { return i == 0 ? x : y; }
+    size_t size () const { return 2; }
+  };
+
+  struct Vec3 {
+    float x, y, z;
+    float  operator[] ( size_t i ) const { return i == 0 ? x : i == 1 ? y : z; }
+    size_t size () const { return 3; }
+  };
+
+  inline Vec2 operator- ( const Vec2 &a, const Vec2 &b ) { return { a.x-b.x, a.y-b.y }; }
+  inline Vec3 operator- ( const Vec3 &a, const Vec3 &b ) { return { a.x-b.x, a.y-b.y, a.z-b.z }; }
+  inline Vec3 cross     ( const Vec3 &a, const Vec3 &b ) {
+    return { a.y*b.z - a.z*b.y, a.z*b.x - a.x*b.z, a.x*b.y - a.y*b.x };
+  }
+  inline float dot      ( const Vec3 &a, const Vec3 &b ) { return a.x*b.x + a.y*b.y + a.z*b.z; }
+
+  // Same format as a Point
+  inline std::ostream &operator<< ( std::ostream &os, const Vec2 &p ) { return os << p.x << ' ' << p.y; }
+  inline std::ostream &operator<< ( std::ostream &os, const Vec3 &p ) { return os << p.x << ' ' << p.y << ' ' << p.z; }
+
+  template < size_t D > struct VecOf             { typedef void type; };
+  template <>           struct VecOf < 2 >       { typedef Vec2 type; };
+  template <>           struct VecOf < 3 >       { typedef Vec3 type; };
+
+  typedef std::vector < float, AlignedAllocator < float > > AlignedFloats;
+
+  // Axes of the dynamic store live in a vector, the others in an array
+  template < size_t D > struct Axes              { AlignedFloats a[D]; };
+  template <>           struct Axes < DYNAMICDIM > { std::vector < AlignedFloats > a; };
+
+  template < size_t D >
+  class Points {
+  private:
+    Axes < D > _axes;
+    size_t     _dim;
+    size_t     _size;
+
+  public:
+    typedef typename VecOf < D >::type value_type;
+
+    explicit Points ( size_t dim = D ) : _dim{dim}, _size{0} {
+      if ( D != DYNAMICDIM && dim != D ) errorM("Points dimension doesn't match its template");
+      axes ( _axes );
+    }
+
+    explicit Points ( const Geometry &geom ) : Points ( geom.getDim() ) { assign ( geom ); }
+
+    // Copies geom, keeping the memory already held
+    void assign ( const Geometry &geom ) {
+      if ( geom.getDim() != _dim ) errorM("Points dimension doesn't match the geometry");
+      resize ( geom.size() );
+      size_t i = 0;
+      for ( const auto &p : geom ) {
+	for ( size_t a=0; a<_dim; a++ ) axis(a)[i] = p[a];
+	i++;
+      }
+    }
+
+    size_t size  () const { return _size; }
+    bool   empty () const { return _size == 0; }
+    size_t dim   () const { return _dim; }
+
+    // Axis a of every point, aligned to a cache line
+    float       *axis ( size_t a )       { return _axes.a[a].data(); }
+    const float *axis ( size_t a ) const { return _axes.a[a].data(); }
+
+    float x ( size_t i ) const { return _axes.a[0][i]; }
+    float y ( size_t i ) const { return _axes.a[1][i]; }
+    float z ( size_t i ) const { static_assert ( D != 2, "2D points have no z" ); return _axes.a[2][i]; }
+    float coord ( size_t i, size_t a ) const { return _axes.a[a][i]; }
+
+    value_type operator[] ( size_t i ) const { return get ( i, (value_type*)NULL ); }
+
+    void set ( size_t i, const Vec2 &p ) {
+      static_assert ( D == 2, "Vec2 needs 2D points" );
+      _axes.a[0][i] = p.x; _axes.a[1][i] = p.y;
+    }
+    void set ( size_t i, const Vec3 &p ) {
+      static_assert ( D == 3, "Vec3 needs 3D points" );
+      _axes.a[0][i] = p.x; _axes.a[1][i] = p.y; _axes.a[2][i] = p.z;
+    }
+    template < typename V >
+    void push_back ( const V &p ) { resize ( _size+1 ); set ( _size-1, p ); }
+
+    void resize  ( size_t n ) { for ( size_t a=0; a<_dim; a++ ) _axes.a[a].resize  ( n ); _size = n; }
+    void reserve ( size_t n ) { for ( size_t a=0; a<_dim; a++ ) _axes.a[a].reserve ( n ); }
+
+  private:
+    void axes ( Axes < DYNAMICDIM > &ax ) { ax.a.resize ( _dim ); }
+    template < typename A > void axes ( A & ) {}
+
+    Vec2 get ( size_t i, Vec2* ) const { return { x(i), y(i) }; }
+    Vec3 get ( size_t i, Vec3* ) const { return { x(i), y(i), z(i) }; }
+  };
+
+  // Largest absolute value of any coordinate, for the error bounds in predicates.hpp
+  template < size_t D >
+  float maxAbsCoord ( const Points < D > &pts ) {
+    float m = 0;
+    for ( size_t a=0; a<pts.dim(); a++ ) {
+      const float *c = pts.axis ( a );
+      for ( size_t i=0; i<pts.size(); i++ ) m = std::max ( m, std::abs ( c[i] ) );
+    }
+    return m;
+  }
+}
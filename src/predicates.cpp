@@ -0,0 +1,340 @@
+/******************************************************
+ * Name    : predicates.cpp
+ * Author  : Kevin Mooney
+ * Created : 17/10/26
+ * Updated :
+ *
+ * Description:
+ *   Scalar, AVX2 and AVX-512 versions of the batched
+ *   predicates and the choice between them
+ *
+ * NOTES:
+ *   - The vector versions are compiled with target
+ *     attributes, like edt2DCpu.cpp, so the rest of the
+ *     build doesn't need -mavx2 and still runs anywhere
+ *   - The points left over after the last full vector
+ *     go to the scalar version
+ ******************************************************/
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <limits>
+
+// g++ fuses multiplies and adds, even of intrinsics, wherever the target
+// has fma. That changes the last bit depending on the instruction set
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC optimize ("fp-contract=off")
+#endif
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define PRED_HAVE_X86
+#include <immintrin.h>
+#endif
+
+#ifdef __clang__
+#pragma clang fp contract(off)
+#endif
+
+#include "predicates.hpp"
+
+#define ORIENT2DBOUND  3.814697265625e-06f	// 64 * 2^-24
+#define PLANESIDEBOUND 6.103515625e-05f		// 1024 * 2^-24
+
+using namespace CompGeom;
+
+SimdLevel CompGeom::cpuSimdLevel () {
+#ifdef PRED_HAVE_X86
+  static const SimdLevel level = __builtin_cpu_supports ( "avx512f" ) ? SIMD_AVX512
+                               : __builtin_cpu_supports ( "avx2"    ) ? SIMD_AVX2
+                               :                                        SIMD_SCALAR;
+  return level;
+#else
+  return SIMD_SCALAR;
+#endif
+}
+
+static std::atomic < int > &currentLevel () {
+  static std::atomic < int > level ( cpuSimdLevel() );
+  return level;
+}
+
+SimdLevel CompGeom::setSimdLevel ( SimdLevel level ) {
+  const SimdLevel l = std::min ( level, cpuSimdLevel() );
+  currentLevel().store ( l, std::memory_order_relaxed );
+  return l;
+}
+
+SimdLevel CompGeom::simdLevel () {
+  return SimdLevel ( currentLevel().load ( std::memory_order_relaxed ) );
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+/////////////////////////////  SCALAR  ///////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+
+static void orient2DScalar ( float ax, float ay, float bx, float by,
+			     const float *x, const float *y, size_t n, float *out )
+{
+  const float ux = bx - ax, uy = by - ay;
+  for ( size_t i=0; i<n; i++ ) out[i] = ux*(y[i] - ay) - uy*(x[i] - ax);
+}
+
+// Folds the points [first,last) into the largest value so far, best at
+// index at, only replacing it with a strictly larger one
+static void maxOrient2DScalar ( float ax, float ay, float bx, float by, const float *x, const float *y,
+				size_t first, size_t last, float &best, size_t &at )
+{
+  const float ux = bx - ax, uy = by - ay;
+  for ( size_t i=first; i<last; i++ ) {
+    const float s = ux*(y[i] - ay) - uy*(x[i] - ax);
+    if ( s > best ) { best = s; at = i; }
+  }
+}
+
+static void planeSideScalar ( const float p[4], const float *x, const float *y, const float *z,
+			      size_t n, float *out )
+{
+  for ( size_t i=0; i<n; i++ ) out[i] = p[0]*x[i] + p[1]*y[i] + p[2]*z[i] + p[3];
+}
+
+static void planesSideScalar ( const float *nx, const float *ny, const float *nz, const float *d,
+			       size_t n, float px, float py, float pz, float *out )
+{
+  for ( size_t f=0; f<n; f++ ) out[f] = nx[f]*px + ny[f]*py + nz[f]*pz + d[f];
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+/////////////////////////////  AVX2  /////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+
+#ifdef PRED_HAVE_X86
+__attribute__ ((target ("avx2")))
+static void orient2DAVX2 ( float ax, float ay, float bx, float by,
+			   const float *x, const float *y, size_t n, float *out )
+{
+  const size_t nv = n - n%8;
+  const __m256 vax = _mm256_set1_ps ( ax     ), vay = _mm256_set1_ps ( ay      );
+  const __m256 vux = _mm256_set1_ps ( bx - ax ), vuy = _mm256_set1_ps ( by - ay );
+  for ( size_t i=0; i<nv; i += 8 ) {
+    const __m256 dx = _mm256_sub_ps ( _mm256_loadu_ps ( x+i ), vax );
+    const __m256 dy = _mm256_sub_ps ( _mm256_loadu_ps ( y+i ), vay );
+    _mm256_storeu_ps ( out+i, _mm256_sub_ps ( _mm256_mul_ps ( vux, dy ), _mm256_mul_ps ( vuy, dx ) ) );
+  }
+  orient2DScalar ( ax, ay, bx, by, x+nv, y+nv, n-nv, out+nv );
+}
+
+// Each lane keeps its largest value and where it was, the same way as
+// the scalar version. The lanes are then combined taking the lowest
+// index of equal values, which is the first the scalar version finds
+__attribute__ ((target ("avx2")))
+static void maxOrient2DAVX2 ( float ax, float ay, float bx, float by, const float *x, const float *y,
+			      size_t n, float &best, size_t &at )
+{
+  const size_t nv = n - n%8;
+  const __m256 vax = _mm256_set1_ps ( ax     ), vay = _mm256_set1_ps ( ay      );
+  const __m256 vux = _mm256_set1_ps ( bx - ax ), vuy = _mm256_set1_ps ( by - ay );
+  __m256i      idx = _mm256_setr_epi32 ( 0, 1, 2, 3, 4, 5, 6, 7 );
+  __m256i      vat = idx;
+  __m256       mx  = _mm256_set1_ps ( best );
+  for ( size_t i=0; i<nv; i += 8 ) {
+    const __m256 dx = _mm256_sub_ps ( _mm256_loadu_ps ( x+i ), vax );
+    const __m256 dy = _mm256_sub_ps ( _mm256_loadu_ps ( y+i ), vay );
+    const __m256 s  = _mm256_sub_ps ( _mm256_mul_ps ( vux, dy ), _mm256_mul_ps ( vuy, dx ) );
+    const __m256 gt = _mm256_cmp_ps ( s, mx, _CMP_GT_OQ );
+    mx  = _mm256_blendv_ps ( mx, s, gt );
+    vat = _mm256_castps_si256 ( _mm256_blendv_ps ( _mm256_castsi256_ps ( vat ), _mm256_castsi256_ps ( idx ), gt ) );
+    idx = _mm256_add_epi32 ( idx, _mm256_set1_epi32 ( 8 ) );
+  }
+
+  float   lm[8];
+  int32_t li[8];
+  _mm256_storeu_ps    ( lm, mx );
+  _mm256_storeu_si256 ( (__m256i *) li, vat );
+  for ( size_t l=0; l<8; l++ )
+    if ( lm[l] > best || ( lm[l] == best && size_t(li[l]) < at ) ) { best = lm[l]; at = li[l]; }
+  maxOrient2DScalar ( ax, ay, bx, by, x, y, nv, n, best, at );
+}
+
+__attribute__ ((target ("avx2")))
+static void planeSideAVX2 ( const float p[4], const float *x, const float *y, const float *z,
+			    size_t n, float *out )
+{
+  const size_t nv = n - n%8;
+  const __m256 n0 = _mm256_set1_ps ( p[0] ), n1 = _mm256_set1_ps ( p[1] );
+  const __m256 n2 = _mm256_set1_ps ( p[2] ), d  = _mm256_set1_ps ( p[3] );
+  for ( size_t i=0; i<nv; i += 8 ) {
+    __m256 s = _mm256_mul_ps ( n0, _mm256_loadu_ps ( x+i ) );
+    s = _mm256_add_ps ( s, _mm256_mul_ps ( n1, _mm256_loadu_ps ( y+i ) ) );
+    s = _mm256_add_ps ( s, _mm256_mul_ps ( n2, _mm256_loadu_ps ( z+i ) ) );
+    _mm256_storeu_ps ( out+i, _mm256_add_ps ( s, d ) );
+  }
+  planeSideScalar ( p, x+nv, y+nv, z+nv, n-nv, out+nv );
+}
+
+__attribute__ ((target ("avx2")))
+static void planesSideAVX2 ( const float *nx, const float *ny, const float *nz, const float *d,
+			     size_t n, float px, float py, float pz, float *out )
+{
+  const size_t nv = n - n%8;
+  const __m256 vx = _mm256_set1_ps ( px ), vy = _mm256_set1_ps ( py ), vz = _mm256_set1_ps ( pz );
+  for ( size_t f=0; f<nv; f += 8 ) {
+    __m256 s = _mm256_mul_ps ( _mm256_loadu_ps ( nx+f ), vx );
+    s = _mm256_add_ps ( s, _mm256_mul_ps ( _mm256_loadu_ps ( ny+f ), vy ) );
+    s = _mm256_add_ps ( s, _mm256_mul_ps ( _mm256_loadu_ps ( nz+f ), vz ) );
+    _mm256_storeu_ps ( out+f, _mm256_add_ps ( s, _mm256_loadu_ps ( d+f ) ) );
+  }
+  planesSideScalar ( nx+nv, ny+nv, nz+nv, d+nv, n-nv, px, py, pz, out+nv );
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////
+/////////////////////////////  AVX-512  //////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+
+__attribute__ ((target ("avx512f")))
+static void orient2DAVX512 ( float ax, float ay, float bx, float by,
+			     const float *x, const float *y, size_t n, float *out )
+{
+  const size_t nv = n - n%16;
+  const __m512 vax = _mm512_set1_ps ( ax     ), vay = _mm512_set1_ps ( ay      );
+  const __m512 vux = _mm512_set1_ps ( bx - ax ), vuy = _mm512_set1_ps ( by - ay );
+  for ( size_t i=0; i<nv; i += 16 ) {
+    const __m512 dx = _mm512_sub_ps ( _mm512_loadu_ps ( x+i ), vax );
+    const __m512 dy = _mm512_sub_ps ( _mm512_loadu_ps ( y+i ), vay );
+    _mm512_storeu_ps ( out+i, _mm512_sub_ps ( _mm512_mul_ps ( vux, dy ), _mm512_mul_ps ( vuy, dx ) ) );
+  }
+  orient2DScalar ( ax, ay, bx, by, x+nv, y+nv, n-nv, out+nv );
+}
+
+__attribute__ ((target ("avx512f")))
+static void maxOrient2DAVX512 ( float ax, float ay, float bx, float by, const float *x, const float *y,
+				size_t n, float &best, size_t &at )
+{
+  const size_t nv = n - n%16;
+  const __m512 vax = _mm512_set1_ps ( ax     ), vay = _mm512_set1_ps ( ay      );
+  const __m512 vux = _mm512_set1_ps ( bx - ax ), vuy = _mm512_set1_ps ( by - ay );
+  __m512i      idx = _mm512_setr_epi32 ( 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15 );
+  __m512i      vat = idx;
+  __m512       mx  = _mm512_set1_ps ( best );
+  for ( size_t i=0; i<nv; i += 16 ) {
+    const __m512    dx = _mm512_sub_ps ( _mm512_loadu_ps ( x+i ), vax );
+    const __m512    dy = _mm512_sub_ps ( _mm512_loadu_ps ( y+i ), vay );
+    const __m512    s  = _mm512_sub_ps ( _mm512_mul_ps ( vux, dy ), _mm512_mul_ps ( vuy, dx ) );
+    const __mmask16 gt = _mm512_cmp_ps_mask ( s, mx, _CMP_GT_OQ );
+    mx  = _mm512_mask_blend_ps    ( gt, mx , s   );
+    vat = _mm512_mask_blend_epi32 ( gt, vat, idx );
+    idx = _mm512_add_epi32 ( idx, _mm512_set1_epi32 ( 16 ) );
+  }
+
+  float   lm[16];
+  int32_t li[16];
+  _mm512_storeu_ps    ( lm, mx );
+  _mm512_storeu_si512 ( li, vat );
+  for ( size_t l=0; l<16; l++ )
+    if ( lm[l] > best || ( lm[l] == best && size_t(li[l]) < at ) ) { best = lm[l]; at = li[l]; }
+  maxOrient2DScalar ( ax, ay, bx, by, x, y, nv, n, best, at );
+}
+
+__attribute__ ((target ("avx512f")))
+static void planeSideAVX512 ( const float p[4], const float *x, const float *y, const float *z,
+			      size_t n, float *out )
+{
+  const size_t nv = n - n%16;
+  const __m512 n0 = _mm512_set1_ps ( p[0] ), n1 = _mm512_set1_ps ( p[1] );
+  const __m512 n2 = _mm512_set1_ps ( p[2] ), d  = _mm512_set1_ps ( p[3] );
+  for ( size_t i=0; i<nv; i += 16 ) {
+    __m512 s = _mm512_mul_ps ( n0, _mm512_loadu_ps ( x+i ) );
+    s = _mm512_add_ps ( s, _mm512_mul_ps ( n1, _mm512_loadu_ps ( y+i ) ) );
+    s = _mm512_add_ps ( s, _mm512_mul_ps ( n2, _mm512_loadu_ps ( z+i ) ) );
+    _mm512_storeu_ps ( out+i, _mm512_add_ps ( s, d ) );
+  }
+  planeSideScalar ( p, x+nv, y+nv, z+nv, n-nv, out+nv );
+}
+
+__attribute__ ((target ("avx512f")))
+static void planesSideAVX512 ( const float *nx, const float *ny, const float *nz, const float *d,
+			       size_t n, float px, float py, float pz, float *out )
+{
+  const size_t nv = n - n%16;
+  const __m512 vx = _mm512_set1_ps ( px ), vy = _mm512_set1_ps ( py ), vz = _mm512_set1_ps ( pz );
+  for ( size_t f=0; f<nv; f += 16 ) {
+    __m512 s = _mm512_mul_ps ( _mm512_loadu_ps ( nx+f ), vx );
+    s = _mm512_add_ps ( s, _mm512_mul_ps ( _mm512_loadu_ps ( ny+f ), vy ) );
+    s = _mm512_add_ps ( s, _mm512_mul_ps ( _mm512_loadu_ps ( nz+f ), vz ) );
+    _mm512_storeu_ps ( out+f, _mm512_add_ps ( s, _mm512_loadu_ps ( d+f ) ) );
+  }
+  planesSideScalar ( nx+nv, ny+nv, nz+nv, d+nv, n-nv, px, py, pz, out+nv );
+}
+#endif
+
+//////////////////////////////////////////////////////////////////////////////////////////
+/////////////////////////////  DISPATCH  /////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////////////////////////
+
+void CompGeom::orient2D ( float ax, float ay, float bx, float by,
+			  const float *x, const float *y, size_t n, float *out )
+{
+#ifdef PRED_HAVE_X86
+  switch ( simdLevel() ) {
+  case SIMD_AVX512: return orient2DAVX512 ( ax, ay, bx, by, x, y, n, out );
+  case SIMD_AVX2  : return orient2DAVX2   ( ax, ay, bx, by, x, y, n, out );
+  default         : break;
+  }
+#endif
+  orient2DScalar ( ax, ay, bx, by, x, y, n, out );
+}
+
+size_t CompGeom::maxOrient2D ( float ax, float ay, float bx, float by,
+			       const float *x, const float *y, size_t n, float &best )
+{
+  size_t at = 0;
+  best = -std::numeric_limits<float>::infinity();
+#ifdef PRED_HAVE_X86
+  switch ( simdLevel() ) {
+  case SIMD_AVX512: maxOrient2DAVX512 ( ax, ay, bx, by, x, y, n, best, at ); return at;
+  case SIMD_AVX2  : maxOrient2DAVX2   ( ax, ay, bx, by, x, y, n, best, at ); return at;
+  default         : break;
+  }
+#endif
+  maxOrient2DScalar ( ax, ay, bx, by, x, y, 0, n, best, at );
+  return at;
+}
+
+void CompGeom::planeSide ( const float plane[4],
+			   const float *x, const float *y, const float *z, size_t n, float *out )
+{
+#ifdef PRED_HAVE_X86
+  switch ( simdLevel() ) {
+  case SIMD_AVX512: return planeSideAVX512 ( plane, x, y, z, n, out );
+  case SIMD_AVX2  : return planeSideAVX2   ( plane, x, y, z, n, out );
+  default         : break;
+  }
+#endif
+  planeSideScalar ( plane, x, y, z, n, out );
+}
+
+void CompGeom::planesSide ( const float *nx, const float *ny, const float *nz, const float *d, size_t n,
+			    float px, float py, float pz, float *out )
+{
+#ifdef PRED_HAVE_X86
+  switch ( simdLevel() ) {
+  case SIMD_AVX512: return planesSideAVX512 ( nx, ny, nz, d, n, px, py, pz, out );
+  case SIMD_AVX2  : return planesSideAVX2   ( nx, ny, nz, d, n, px, py, pz, out );
+  default         : break;
+  }
+#endif
+  planesSideScalar ( nx, ny, nz, d, n, px, py, pz, out );
+}
+
+// Worked through the rounding of every operation for coordinates no bigger
+// than M, with u = 2^-24. Differences are out by 2Mu and the products of
+// them by 12M^2u, orient2D ends up within 32M^2u. The normal is within
+// 32M^2u per axis and the centre of mass 8Mu, so d, the three products and
+// the sums of planeSide come to 560M^3u. Both are rounded up to a power of 2
+float CompGeom::orient2DErrorBound ( float maxCoord ) {
+  return maxCoord * maxCoord * ORIENT2DBOUND;
+}
+
+float CompGeom::planeSideErrorBound ( float maxCoord ) {
+  return maxCoord * maxCoord * maxCoord * PLANESIDEBOUND;
+}
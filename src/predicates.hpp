@@ -0,0 +1,66 @@
+/******************************************************
+ * Name    : predicates.hpp
+ * Author  : Kevin Mooney
+ * Created : 17/10/26
+ * Updated :
+ *
+ * Description:
+ *   Orientation and plane side tests over many points
+ *   or many planes at once
+ *
+ * NOTES:
+ *   - Each test has a scalar version, an AVX2 version
+ *     doing 8 at a time and an AVX-512 version doing 16.
+ *     The best one the cpu has is picked at run time
+ *   - Every version does the same multiplies and adds in
+ *     the same order, without fused multiply adds, so
+ *     the results are identical whichever one is run
+ *   - Results are signed, the sign is the test and the
+ *     size is twice the area or a multiple of the
+ *     distance
+ *   - The error bounds say which signs can be trusted,
+ *     the rest go to exactPredicates.hpp
+ ******************************************************/
+
+#pragma once
+
+#include <cstddef>
+
+namespace CompGeom {
+
+  enum SimdLevel { SIMD_SCALAR, SIMD_AVX2, SIMD_AVX512 };
+
+  // The widest instructions the cpu has
+  SimdLevel cpuSimdLevel ();
+
+  // The predicates use level or the cpu's level, whichever is lower
+  // Returns the level they now use. Starts at cpuSimdLevel()
+  SimdLevel setSimdLevel ( SimdLevel level );
+  SimdLevel simdLevel    ();
+
+  // out[i] = (b-a) x (p_i-a), positive if p_i is left of a->b
+  void orient2D   ( float ax, float ay, float bx, float by,
+		    const float *x, const float *y, size_t n, float *out );
+
+  // Index of the largest orient2D of the points, the first if several are
+  // equal. Its value is written to best. n must be at least 1
+  size_t maxOrient2D ( float ax, float ay, float bx, float by,
+		       const float *x, const float *y, size_t n, float &best );
+
+  // out[i] = plane . (p_i,1), positive if p_i is in front of the plane
+  // plane is (n0,n1,n2,d) as in Triangle
+  void planeSide  ( const float plane[4],
+		    const float *x, const float *y, const float *z, size_t n, float *out );
+
+  // out[f] = (nx[f],ny[f],nz[f],d[f]) . (p,1), the same for n planes against one point
+  void planesSide ( const float *nx, const float *ny, const float *nz, const float *d, size_t n,
+		    float px, float py, float pz, float *out );
+
+  // Largest error of orient2D for points with no coordinate bigger than
+  // maxCoord, a result further from zero than this has the right sign
+  float orient2DErrorBound  ( float maxCoord );
+
+  // The same for planeSide and planesSide, with planes made by Triangle
+  // from points within the same bound
+  float planeSideErrorBound ( float maxCoord );
+}
@@ -0,0 +1,114 @@
+/******************************************************
+ * Name    : quickHull3D.cpp
+ * Author  : Kevin Mooney
+ * Created : 17/10/26
+ * Updated :
+ *
+ * Description:
+ *
+ * NOTES:
+ *   - The first tetrahedron is the points farthest in x,
+ *     then the point farthest from the line through
+ *     them and the point farthest from their plane
+ *   - The rest is hullRounds, each face adding the point
+ *     farthest in front of it
+ ******************************************************/
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "errorMessages.hpp"
+#include "exactPredicates.hpp"
+#include "hullRounds.hpp"
+#include "predicates.hpp"
+#include "quickHull3D.hpp"
+#include "threadPool.hpp"
+#include "triangle.hpp"
+
+#define EXTREMEBLOCK 8192		// Points looked at in one task
+
+using namespace std;
+
+namespace {
+
+  // Index of the largest score, the first if several are equal. score(lo,hi,out)
+  // writes the scores of points [lo,hi) to out
+  template < typename Score >
+  uint32_t farthest ( const CompGeom::Points<3> &geom, Score score ) {
+    const size_t n      = geom.size();
+    const size_t nTasks = ( n + EXTREMEBLOCK - 1 ) / EXTREMEBLOCK;
+    const auto threads = CompGeom::threadPool();
+    vector < CompGeom::AlignedFloats >  scratch ( threads->size(), CompGeom::AlignedFloats ( EXTREMEBLOCK ) );
+    vector < pair < float, uint32_t > > best ( nTasks );
+    threads->run ( nTasks, [&] ( size_t t, size_t worker ) {
+	const size_t lo = t*EXTREMEBLOCK, hi = min ( n, lo + EXTREMEBLOCK );
+	float *s = scratch[worker].data();
+	score ( lo, hi, s );
+	size_t b = 0;
+	for ( size_t i=1; i<hi-lo; i++ ) if ( s[i] > s[b] ) b = i;
+	best[t] = { s[b], uint32_t ( lo + b ) };
+      } );
+
+    pair < float, uint32_t > b = best[0];
+    for ( const auto &o : best ) if ( o.first > b.first ) b = o;
+    return b.second;
+  }
+
+  // First id for which test is true
+  template < typename Test >
+  uint32_t findFirst ( const CompGeom::Points<3> &geom, Test test ) {
+    for ( size_t i=0; i<geom.size(); i++ )
+      if ( test ( geom[i] ) ) return uint32_t ( i );
+    errorM ( "3D hull needs 4 points that aren't coplanar" );
+    return 0;
+  }
+
+  // The first tetrahedron from points far apart. The farthest points are
+  // found in floats, if they are degenerate the first that aren't are used
+  void start ( const CompGeom::Points<3> &geom, uint32_t id[4] ) {
+    typedef CompGeom::Vec3 Vec;
+    const float *x = geom.axis ( 0 ), *y = geom.axis ( 1 ), *z = geom.axis ( 2 );
+
+    id[0] = farthest ( geom, [&] ( size_t lo, size_t hi, float *s ) {
+	for ( size_t i=lo; i<hi; i++ ) s[i-lo] = -x[i]; } );
+    id[1] = farthest ( geom, [&] ( size_t lo, size_t hi, float *s ) {
+	for ( size_t i=lo; i<hi; i++ ) s[i-lo] = x[i]; } );
+    const Vec p0 = geom[id[0]];
+    auto differs = [&] ( const Vec &p ) { return p.x != p0.x || p.y != p0.y || p.z != p0.z; };
+    if ( !differs ( geom[id[1]] ) ) id[1] = findFirst ( geom, differs );
+
+    const Vec p1 = geom[id[1]], u = p1 - p0;
+    id[2] = farthest ( geom, [&] ( size_t lo, size_t hi, float *s ) {
+	for ( size_t i=lo; i<hi; i++ ) {
+	  const Vec c = CompGeom::cross ( u, Vec { x[i], y[i], z[i] } - p0 );
+	  s[i-lo] = CompGeom::dot ( c, c );
+	} } );
+    auto off = [&] ( const Vec &p ) { return !CompGeom::collinearExact ( p0, p1, p ); };
+    if ( !off ( geom[id[2]] ) ) id[2] = findFirst ( geom, off );
+
+    const Vec p2 = geom[id[2]];
+    const CompGeom::Triangle base { id[0], id[1], id[2], geom };
+    id[3] = farthest ( geom, [&] ( size_t lo, size_t hi, float *s ) {
+	CompGeom::planeSide ( base.plane(), x+lo, y+lo, z+lo, hi-lo, s );
+	for ( size_t i=0; i<hi-lo; i++ ) s[i] = abs ( s[i] );
+      } );
+    auto above = [&] ( const Vec &p ) { return CompGeom::orient3DExact ( p0, p1, p2, p ) != 0; };
+    if ( !above ( geom[id[3]] ) ) id[3] = findFirst ( geom, above );
+  }
+}
+
+vector < vector < size_t > > quickHull3D ( const CompGeom::Geometry &geom ) {
+  if ( geom.getDim() != 3 ) errorM ( "quickHull3D only works in 3 dimensions" );
+  return quickHull3D ( CompGeom::Points<3> ( geom ) );
+}
+
+vector < vector < size_t > > quickHull3D ( const CompGeom::Points<3> &geom ) {
+  if ( geom.size() < 4 ) errorM ( "3D hull must have at least 4 points" );
+
+  uint32_t tet[4];
+  start ( geom, tet );
+  return CompGeom::hullRounds ( geom, tet );
+}
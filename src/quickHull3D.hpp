@@ -0,0 +1,30 @@
+/******************************************************
+ * Name    : quickHull3D.hpp
+ * Author  : Kevin Mooney
+ * Created : 17/10/26
+ * Updated :
+ *
+ * Description:
+ *   3D QuickHull on the cpu threads. Each face keeps
+ *   the points outside it and the farthest of them is
+ *   added next, faces far enough apart are worked on at
+ *   the same time
+ *
+ * NOTES:
+ *   - C. B. Barber, D. P. Dobkin and H. Huhdanpaa, "The
+ *     Quickhull algorithm for convex hulls"
+ *   - The output doesn't depend on the number of
+ *     threads, see setNumThreads in parallel.hpp
+ *   - Triangles are anti-clockwise viewed from outside,
+ *     the same as insertion3D
+ ******************************************************/
+
+#pragma once
+
+#include <vector>
+
+#include "geometry.hpp"
+#include "points.hpp"
+
+std::vector < std::vector < size_t > > quickHull3D ( const CompGeom::Geometry &geom );
+std::vector < std::vector < size_t > > quickHull3D ( const CompGeom::Points<3> &geom );
@@ -0,0 +1,102 @@
+/******************************************************
+ * Name    : radixSort.hpp
+ * Author  : Kevin Mooney
+ * Created : 17/10/26
+ * Updated :
+ *
+ * Description:
+ *   Parallel LSD radix sort and dedup of 64 bit keys,
+ *   the cpu counterpart of the thrust::sort and
+ *   thrust::unique calls in gHull.cu
+ *
+ * NOTES:
+ *   - Each thread histograms its own block of keys,
+ *     a scan over (digit,block) gives every block its
+ *     place in the output, so each pass is stable
+ *   - Only the lowest `bits` bits are sorted on, pack
+ *     keys tightly to save passes
+ *   - scratch and counts are working memory, they are
+ *     arguments so callers can keep them between calls
+ ******************************************************/
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "parallel.hpp"
+
+#define RADIXBITS  8			// Bits sorted on in each pass
+#define RADIX      (1 << RADIXBITS)
+#define RADIXBLOCK 16384		// Fewest keys given to one thread
+
+namespace CompGeom {
+
+  // Blocks the keys are split into, one per thread unless there are few keys
+  inline size_t radixBlocks ( size_t n ) {
+    return std::max < size_t > ( 1, std::min ( numThreads(), n / RADIXBLOCK ) );
+  }
+
+  // Sorts keys in ascending order of their lowest bits bits
+  inline void radixSort ( std::vector < uint64_t > &keys, std::vector < uint64_t > &scratch,
+			  std::vector < size_t > &counts, unsigned bits )
+  {
+    const size_t n  = keys.size();
+    const size_t nb = radixBlocks ( n );
+    scratch.resize ( n );
+    counts .resize ( nb*RADIX );
+
+    for ( unsigned shift = 0; shift < bits; shift += RADIXBITS ) {
+      std::fill ( counts.begin(), counts.end(), 0 );
+      parallelFor ( nb, [&] ( size_t b ) {
+	  size_t *c = &counts[b*RADIX];
+	  for ( size_t i = b*n/nb; i < (b+1)*n/nb; i++ ) c[(keys[i] >> shift) & (RADIX-1)]++;
+	} );
+
+      // Exclusive scan, all blocks of a digit come before the next digit
+      size_t sum = 0;
+      for ( size_t d=0; d<RADIX; d++ ) {
+	for ( size_t b=0; b<nb; b++ ) {
+	  const size_t c = counts[b*RADIX+d];
+	  counts[b*RADIX+d] = sum;
+	  sum += c;
+	}
+      }
+
+      parallelFor ( nb, [&] ( size_t b ) {
+	  size_t *c = &counts[b*RADIX];
+	  for ( size_t i = b*n/nb; i < (b+1)*n/nb; i++ )
+	    scratch[c[(keys[i] >> shift) & (RADIX-1)]++] = keys[i];
+	} );
+      keys.swap ( scratch );
+    }
+  }
+
+  // Removes repeated keys from a sorted vector
+  inline void uniqueSorted ( std::vector < uint64_t > &keys, std::vector < uint64_t > &scratch,
+			     std::vector < size_t > &counts )
+  {
+    const size_t n  = keys.size();
+    const size_t nb = radixBlocks ( n );
+    auto first = [&] ( size_t i ) { return i == 0 || keys[i] != keys[i-1]; };
+
+    scratch.resize ( n );
+    counts .resize ( nb+1 );
+    parallelFor ( nb, [&] ( size_t b ) {
+	size_t c = 0;
+	for ( size_t i = b*n/nb; i < (b+1)*n/nb; i++ ) c += first(i);
+	counts[b+1] = c;
+      } );
+
+    counts[0] = 0;
+    for ( size_t b=0; b<nb; b++ ) counts[b+1] += counts[b];
+
+    parallelFor ( nb, [&] ( size_t b ) {
+	size_t out = counts[b];
+	for ( size_t i = b*n/nb; i < (b+1)*n/nb; i++ ) if ( first(i) ) scratch[out++] = keys[i];
+      } );
+    keys.swap   ( scratch   );
+    keys.resize ( counts[nb] );
+  }
+}
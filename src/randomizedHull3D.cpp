@@ -0,0 +1,242 @@
+/******************************************************
+ * Name    : randomizedHull3D.cpp
+ * Author  : Kevin Mooney
+ * Created : 17/10/26
+ * Updated :
+ *
+ * Description:
+ *
+ * NOTES:
+ *   - Each point waiting to be added is in the conflict
+ *     list of one face it can see. The faces it sees are
+ *     joined up, so the rest are found by walking out
+ *     from that one
+ *   - A point that could see a removed face either sees
+ *     one of the new faces or is inside the hull, so only
+ *     the new faces are tested when the points of the
+ *     removed faces are handed on. Points inside the hull
+ *     are dropped then and never looked at again
+ *   - Conflict lists hold copies of the points with their
+ *     rank, their place in the random order, so handing
+ *     them on reads through memory in order. Faces keep
+ *     the ids of their vertices
+ *   - Sides are tested against the float planes and only
+ *     recomputed with orient3DExact within their bound,
+ *     so every point sees a face it really is in front of
+ ******************************************************/
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include "errorMessages.hpp"
+#include "exactPredicates.hpp"
+#include "predicates.hpp"
+#include "randomizedHull3D.hpp"
+#include "triangle.hpp"
+
+#define NOFACE UINT32_MAX		// Owner of a point inside the hull
+
+using namespace std;
+
+namespace {
+
+  // A point waiting to be added
+  struct Waiting {
+    CompGeom::Vec3 p;
+    uint32_t       rank;
+  };
+
+  struct ConflictHull {
+    const CompGeom::Points<3>           &geom;
+    const float                          bound;	// Error of the planes, see planeSideErrorBound
+    vector < uint32_t >                  order;	// Point id of each rank
+
+    vector < CompGeom::Triangle >        tris;
+    vector < array < uint32_t, 3 > >     nbrs;	// Face across the edge from vertex k to k+1
+    vector < char >                      alive;
+    vector < uint32_t >                  mark;	// Rank + 1 of the last point tested against the face
+    vector < char >                      front;	// The result of that test
+    vector < vector < Waiting > >        points;	// Points each face owns
+
+    vector < uint32_t >                  owner;	// Face each point is waiting on, by rank
+    vector < uint32_t >                  startAt;	// New face whose horizon edge starts at each id
+    vector < uint32_t >                  visible, fresh;
+
+    ConflictHull ( const CompGeom::Points<3> &pts, unsigned seed ) :
+      geom    { pts },
+      bound   { CompGeom::planeSideErrorBound ( CompGeom::maxAbsCoord ( pts ) ) },
+      order   ( randomOrder ( pts, seed ) ),
+      owner   ( pts.size(), NOFACE ),
+      startAt ( pts.size() ) {}
+
+    CompGeom::Vec3 at ( size_t rank ) const { return geom[order[rank]]; }
+
+    uint32_t add ( uint32_t id0, uint32_t id1, uint32_t id2 ) {
+      tris  .push_back ( CompGeom::Triangle { id0, id1, id2, geom } );
+      nbrs  .push_back ( {{ 0, 0, 0 }} );
+      alive .push_back ( 1 );
+      mark  .push_back ( 0 );
+      front .push_back ( 0 );
+      points.push_back ( {} );
+      return uint32_t ( tris.size() - 1 );
+    }
+
+    // p is strictly in front of face t
+    bool sees ( const CompGeom::Triangle &t, const CompGeom::Vec3 &p ) const {
+      const float *pl = t.plane();
+      const float  s  = pl[0]*p.x + pl[1]*p.y + pl[2]*p.z + pl[3];
+      if ( s >  bound ) return true;
+      if ( s < -bound ) return false;
+      return CompGeom::orient3DExact ( geom[t[0]], geom[t[1]], geom[t[2]], p ) > 0;
+    }
+
+    // The same for the point of rank r, only testing each face once
+    bool seen ( uint32_t f, uint32_t r, const CompGeom::Vec3 &p ) {
+      if ( mark[f] != r+1 ) { mark[f] = r+1; front[f] = sees ( tris[f], p ); }
+      return front[f];
+    }
+
+    // The first of the faces that w sees takes it
+    template < typename It >
+    void assign ( const Waiting &w, It first, It last ) {
+      owner[w.rank] = NOFACE;
+      for ( ; first != last; ++first ) {
+	if ( sees ( tris[*first], w.p ) ) {
+	  owner[w.rank] = *first;
+	  points[*first].push_back ( w );
+	  return;
+	}
+      }
+    }
+
+    // Edge k of g that runs from a to b
+    size_t edge ( uint32_t g, uint32_t a, uint32_t b ) const {
+      const CompGeom::Triangle &t = tris[g];
+      for ( size_t k=0; k<3; k++ )
+	if ( t[k] == a && t[(k+1)%3] == b ) return k;
+      errorM ( "Hull faces aren't joined up" );
+      return 0;
+    }
+
+    void insert ( uint32_t r );
+  };
+
+  void ConflictHull::insert ( uint32_t r ) {
+    if ( owner[r] == NOFACE ) return;	// Inside the hull
+
+    // The visible faces, out from the owner
+    const CompGeom::Vec3 p = at ( r );
+    visible.assign ( 1, owner[r] );
+    mark [owner[r]] = r+1;
+    front[owner[r]] = 1;
+    for ( size_t i=0; i<visible.size(); i++ ) {
+      for ( auto g : nbrs[visible[i]] ) {
+	if ( mark[g] != r+1 && seen ( g, r, p ) ) visible.push_back ( g );
+      }
+    }
+
+    // A new face on each horizon edge, oriented the same as the visible face
+    const uint32_t id = order[r];
+    fresh.clear();
+    for ( auto f : visible ) {
+      for ( size_t k=0; k<3; k++ ) {
+	const uint32_t g = nbrs[f][k];
+	if ( seen ( g, r, p ) ) continue;
+
+	const uint32_t a = tris[f][k], b = tris[f][(k+1)%3];
+	const uint32_t h = add ( a, b, id );
+	nbrs[h][0] = g;
+	nbrs[g][edge ( g, b, a )] = h;
+	startAt[a] = h;
+	fresh.push_back ( h );
+      }
+    }
+
+    // Each new face meets the ones starting and ending at its horizon edge
+    for ( auto h : fresh ) {
+      const uint32_t next = startAt[tris[h][1]];
+      nbrs[h][1]    = next;
+      nbrs[next][2] = h;
+    }
+
+    for ( auto f : visible ) {
+      for ( const auto &w : points[f] ) {
+	if ( w.rank != r ) assign ( w, fresh.begin(), fresh.end() );
+      }
+      alive[f] = 0;
+      vector < Waiting > ().swap ( points[f] );
+    }
+  }
+
+  // First rank from start whose point passes test
+  template < typename Test >
+  uint32_t findFirst ( const CompGeom::Points<3> &geom, const vector < uint32_t > &order,
+		       uint32_t start, Test test ) {
+    for ( uint32_t r=start; r<order.size(); r++ )
+      if ( test ( geom[order[r]] ) ) return r;
+    errorM ( "3D hull needs 4 points that aren't coplanar" );
+    return 0;
+  }
+}
+
+vector < uint32_t > randomOrder ( const CompGeom::Points<3> &geom, unsigned seed ) {
+  vector < uint32_t > order ( geom.size() );
+  iota ( order.begin(), order.end(), 0 );
+  default_random_engine gen ( seed );
+  shuffle ( order.begin(), order.end(), gen );
+
+  // The first tetrahedron is moved to the first four ranks
+  typedef CompGeom::Vec3 Vec;
+  auto at = [&] ( uint32_t r ) { return geom[order[r]]; };
+  const Vec      p0 = at ( 0 );
+  const uint32_t r1 = findFirst ( geom, order, 1, [&] ( const Vec &p ) {
+      return p.x != p0.x || p.y != p0.y || p.z != p0.z; } );
+  swap ( order[1], order[r1] );
+  const uint32_t r2 = findFirst ( geom, order, 2, [&] ( const Vec &p ) {
+      return !CompGeom::collinearExact ( p0, at ( 1 ), p ); } );
+  swap ( order[2], order[r2] );
+  const uint32_t r3 = findFirst ( geom, order, 3, [&] ( const Vec &p ) {
+      return CompGeom::orient3DExact ( p0, at ( 1 ), at ( 2 ), p ) != 0; } );
+  swap ( order[3], order[r3] );
+  return order;
+}
+
+vector < vector < size_t > > randomizedHull3D ( const CompGeom::Geometry &geom, unsigned seed ) {
+  if ( geom.getDim() != 3 ) errorM ( "randomizedHull3D only works in 3 dimensions" );
+  return randomizedHull3D ( CompGeom::Points<3> ( geom ), seed );
+}
+
+vector < vector < size_t > > randomizedHull3D ( const CompGeom::Points<3> &geom, unsigned seed ) {
+  if ( geom.size() < 4 ) errorM ( "3D hull must have at least 4 points" );
+  if ( geom.size() >= NOFACE ) errorM ( "3D hull ids must fit in 32 bits" );
+
+  ConflictHull H ( geom, seed );
+
+  const bool      flip  = CompGeom::orient3DExact ( H.at ( 0 ), H.at ( 1 ), H.at ( 2 ), H.at ( 3 ) ) > 0;
+  const uint32_t *o     = H.order.data();
+  const uint32_t  t0[3] = { o[0], flip ? o[2] : o[1], flip ? o[1] : o[2] };
+  H.add ( t0[0], t0[1], t0[2] );
+  H.add ( t0[0], t0[2], o[3] );
+  H.add ( t0[2], t0[1], o[3] );
+  H.add ( t0[1], t0[0], o[3] );
+  for ( uint32_t f=0; f<4; f++ )
+    for ( uint32_t g=0; g<4; g++ )
+      for ( size_t k=0; k<3; k++ )
+	for ( size_t j=0; j<3; j++ )
+	  if ( H.tris[f][k] == H.tris[g][(j+1)%3] && H.tris[f][(k+1)%3] == H.tris[g][j] ) H.nbrs[f][k] = g;
+
+  const uint32_t first[4] = { 0, 1, 2, 3 };
+  for ( uint32_t r=4; r<geom.size(); r++ ) H.assign ( Waiting { H.at ( r ), r }, first, first+4 );
+
+  for ( uint32_t r=4; r<geom.size(); r++ ) H.insert ( r );
+
+  vector < vector < size_t > > result;
+  for ( size_t f=0; f<H.tris.size(); f++ ) {
+    if ( H.alive[f] ) result.push_back ( { H.tris[f][0], H.tris[f][1], H.tris[f][2] } );
+  }
+  return result;
+}
@@ -0,0 +1,39 @@
+/******************************************************
+ * Name    : randomizedHull3D.hpp
+ * Author  : Kevin Mooney
+ * Created : 17/10/26
+ * Updated :
+ *
+ * Description:
+ *   Randomized incremental 3D hull. The points are
+ *   added in a random order and a conflict graph says
+ *   which faces each one can see, so only those faces
+ *   are looked at when it is added
+ *
+ * NOTES:
+ *   - K. L. Clarkson and P. W. Shor, "Applications of
+ *     random sampling in computational geometry, II"
+ *   - Expected O(n log n) for any input, the order is
+ *     fixed by seed so the output is repeatable
+ *   - Triangles are anti-clockwise viewed from outside,
+ *     the same as insertion3D
+ ******************************************************/
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "geometry.hpp"
+#include "points.hpp"
+
+const unsigned DEFAULT_HULL_SEED = 1432543;
+
+std::vector < std::vector < size_t > > randomizedHull3D ( const CompGeom::Geometry &geom,
+							  unsigned seed = DEFAULT_HULL_SEED );
+std::vector < std::vector < size_t > > randomizedHull3D ( const CompGeom::Points<3> &geom,
+							  unsigned seed = DEFAULT_HULL_SEED );
+
+// The ids of geom in the order randomizedHull3D adds them, the first four
+// are moved forward from later in the order if they are coplanar
+std::vector < uint32_t > randomOrder ( const CompGeom::Points<3> &geom, unsigned seed = DEFAULT_HULL_SEED );
@@ -2,49 +2,218 @@
  * Name    : star.hpp
  * Author  : Kevin Mooney
  * Created : 18/08/16
- * Updated : 
+ * Updated : 17/10/26
  *
  * Description:
+ *   The star of a point is the cone of hull triangles
+ *   around it, stored as the ring of its neighbours
  *
  * NOTES:
+ *   - Triangle (id, star[i], star[i+1]) faces outwards
+ *   - A dead star's point is inside the hull, its edges
+ *     are then the points that enclose it
+ *   - All stars live in one StarArena, laid out like
+ *     Stars in gHull.cu. Each star has STARCAPACITY
+ *     slots used as a ring buffer, so inserting and
+ *     erasing only moves the shorter side of the ring
+ *     and ranges can wrap past the end
+ *   - A star that outgrows its slots is moved to a ring
+ *     of its own, doubled in size whenever it fills
+ *   - Star is a handle, it stays valid as the arena
+ *     grows but not after clear()
  ******************************************************/
 
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <iterator>
 #include <vector>
 
-#include "workingSet.hpp"
+#define STARCAPACITY 16			// Edges held in the arena, a power of 2
+#define NOSPILL	     0xFFFFFFFFu	// Star still fits in the arena
 
 namespace CompGeom {
 
+  class StarArena;
+
   class Star {
   private:
-    typedef std::vector<size_t> container;
-    
+    StarArena *_arena;
+    uint32_t   _index;
+
+    uint32_t *ring     () const;
+    uint32_t  mask     () const;
+    uint32_t  slot     ( size_t i ) const { return ( head() + i ) & mask(); }
+    uint32_t &head     () const;
+    uint32_t &sizeRef  () const;
+    void      grow     ();
+
   public:
-    size_t id;
-    std::vector<size_t> edges;
-    
-    Star ( const size_t &id ) : id{id} {}
-
-    typedef typename std::vector<size_t>::iterator iterator;
-    typedef typename std::vector<size_t>::const_iterator const_iterator;
-    iterator       begin()        { return edges.begin(); }
-    iterator       end()          { return edges.end();   }
-    const_iterator begin() const  { return edges.begin(); }
-    const_iterator end()   const  { return edges.end();   }
-    
-    size_t front() const { return edges.front(); }
-    size_t back()  const { return edges.back (); }
-
-    void     insert ( const iterator &it, const size_t &id     ) {        edges.insert( it, id ); }
-    iterator erase  ( const iterator &it                       ) { return edges.erase ( it     ); }
-    iterator erase  ( const iterator &it1, const iterator &it2 ) { return edges.erase ( it1,it2); }
-    
-    bool empty() {return edges.empty();}
-    
-    size_t size() const { return edges.size(); }
-    size_t &operator[](size_t i) { return edges[i]; }
-    const size_t &operator[](size_t i) const { return edges[i]; }
+    Star ( StarArena *arena, uint32_t index ) : _arena{arena}, _index{index} {}
+
+    class const_iterator {
+      const Star *_star;
+      size_t      _i;
+    public:
+      typedef std::forward_iterator_tag iterator_category;
+      typedef uint32_t                  value_type;
+      typedef std::ptrdiff_t            difference_type;
+      typedef const uint32_t           *pointer;
+      typedef uint32_t                  reference;
+
+      const_iterator ( const Star *star, size_t i ) : _star{star}, _i{i} {}
+      uint32_t        operator*  () const { return (*_star)[_i]; }
+      const_iterator &operator++ ()       { _i++; return *this; }
+      const_iterator  operator++ ( int )  { const_iterator it = *this; _i++; return it; }
+      bool operator== ( const const_iterator &it ) const { return _i == it._i; }
+      bool operator!= ( const const_iterator &it ) const { return _i != it._i; }
+    };
+
+    uint32_t index () const { return _index; }
+    uint32_t id    () const;
+    bool     alive () const;
+    void     kill  ();
+
+    size_t size  () const { return sizeRef(); }
+    bool   empty () const { return size() == 0; }
+
+    uint32_t operator[] ( size_t i ) const { return ring()[slot(i)]; }
+    uint32_t front () const { return (*this)[0];        }
+    uint32_t back  () const { return (*this)[size()-1]; }
+
+    const_iterator begin () const { return const_iterator ( this, 0      ); }
+    const_iterator end   () const { return const_iterator ( this, size() ); }
+
+    // Inserts id before edge pos, pos == size() appends
+    void insert    ( size_t pos, uint32_t id );
+    void push_back ( uint32_t id ) { insert ( size(), id ); }
+
+    // Erases count edges starting at pos, wrapping round to the front
+    void erase  ( size_t pos, size_t count );
+
+    template < typename iter >
+    void assign ( iter first, iter last ) { sizeRef() = 0; for ( ; first != last; ++first ) push_back ( *first ); }
+    void assign ( std::initializer_list < uint32_t > ids ) { assign ( ids.begin(), ids.end() ); }
   };
+
+  class StarArena {
+  private:
+    friend class Star;
+
+    std::vector < uint32_t > _ids;
+    std::vector < uint8_t  > _alive;
+    std::vector < uint32_t > _heads;	// Slot of the first edge
+    std::vector < uint32_t > _sizes;
+    std::vector < uint32_t > _spills;	// Index into _spilled or NOSPILL
+    std::vector < uint32_t > _edges;	// STARCAPACITY slots per star
+    std::vector < std::vector < uint32_t > > _spilled;
+
+  public:
+    size_t size  () const { return _ids.size(); }
+    bool   empty () const { return _ids.empty(); }
+    size_t nSpilled () const { return _spilled.size(); }
+
+    Star operator[] ( size_t i ) { return Star ( this, i ); }
+
+    // Adds an empty star for point id
+    Star add ( uint32_t id ) {
+      _ids   .push_back ( id );
+      _alive .push_back ( 1 );
+      _heads .push_back ( 0 );
+      _sizes .push_back ( 0 );
+      _spills.push_back ( NOSPILL );
+      _edges .resize ( _edges.size() + STARCAPACITY );
+      return Star ( this, _ids.size()-1 );
+    }
+
+    // Adds a copy of a star of another arena
+    Star add ( const Star &s ) {
+      Star copy = add ( s.id() );
+      copy.assign ( s.begin(), s.end() );
+      if ( !s.alive() ) copy.kill();
+      return copy;
+    }
+
+    void reserve ( size_t n ) {
+      _ids.reserve ( n ); _alive.reserve ( n ); _heads.reserve ( n ); _sizes.reserve ( n );
+      _spills.reserve ( n ); _edges.reserve ( n*STARCAPACITY );
+    }
+
+    // Keeps the memory for the next use
+    void clear () {
+      _ids.clear(); _alive.clear(); _heads.clear(); _sizes.clear();
+      _spills.clear(); _edges.clear(); _spilled.clear();
+    }
+  };
+
+  inline uint32_t  Star::id    () const { return _arena->_ids  [_index];     }
+  inline bool      Star::alive () const { return _arena->_alive[_index];     }
+  inline void      Star::kill  ()       {        _arena->_alive[_index] = 0; }
+  inline uint32_t &Star::head  () const { return _arena->_heads[_index];     }
+  inline uint32_t &Star::sizeRef () const { return _arena->_sizes[_index];   }
+
+  inline uint32_t *Star::ring () const {
+    const uint32_t s = _arena->_spills[_index];
+    return s == NOSPILL ? &_arena->_edges[size_t(_index)*STARCAPACITY] : _arena->_spilled[s].data();
+  }
+
+  inline uint32_t Star::mask () const {
+    const uint32_t s = _arena->_spills[_index];
+    return ( s == NOSPILL ? STARCAPACITY : _arena->_spilled[s].size() ) - 1;
+  }
+
+  // Moves the ring to one twice the size, with the first edge in slot 0
+  inline void Star::grow () {
+    std::vector < uint32_t > bigger ( 2*(mask()+1) );
+    for ( size_t i=0; i<size(); i++ ) bigger[i] = (*this)[i];
+
+    uint32_t &s = _arena->_spills[_index];
+    if ( s == NOSPILL ) {
+      s = _arena->_spilled.size();
+      _arena->_spilled.push_back ( std::move ( bigger ) );
+    }
+    else _arena->_spilled[s].swap ( bigger );
+    head() = 0;
+  }
+
+  // Moves whichever side of pos is shorter out by one slot
+  inline void Star::insert ( size_t pos, uint32_t id ) {
+    if ( size() == mask()+1 ) grow();
+    uint32_t *r = ring();
+    const size_t n = size();
+
+    if ( pos < n - pos ) {
+      head() = ( head() + mask() ) & mask();
+      for ( size_t i=0; i<pos; i++ ) r[slot(i)] = r[slot(i+1)];
+    }
+    else {
+      for ( size_t i=n; i>pos; i-- ) r[slot(i)] = r[slot(i-1)];
+    }
+    r[slot(pos)] = id;
+    sizeRef()++;
+  }
+
+  inline void Star::erase ( size_t pos, size_t count ) {
+    const size_t n = size();
+    if ( count == 0 ) return;
+
+    // Wrapping past the end leaves [pos+count-n, pos) as the star
+    if ( pos + count > n ) {
+      head()    = slot ( pos + count - n );
+      sizeRef() = n - count;
+      return;
+    }
+
+    uint32_t *r = ring();
+    if ( pos < n - pos - count ) {
+      for ( size_t i=pos; i>0; i-- ) r[slot(i-1+count)] = r[slot(i-1)];
+      head() = slot ( count );
+    }
+    else {
+      for ( size_t i=pos; i+count<n; i++ ) r[slot(i)] = r[slot(i+count)];
+    }
+    sizeRef() = n - count;
+  }
 }
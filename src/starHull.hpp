@@ -2,85 +2,69 @@
  * Name    : starHull.hpp
  * Author  : Kevin Mooney
  * Created : 25/08/16
- * Updated : 
+ * Updated : 17/10/26
  *
  * Description:
+ *   Trace of star splaying, every update writes all the
+ *   stars and the triangles they make as one timestep
  *
- * ToDo:
+ * NOTES:
+ *   - Streamed to file like ConvexHull3D
  ******************************************************/
 
+#pragma once
+
+#include <algorithm>
+#include <array>
 #include <set>
 #include <string>
-#include <vector>
 
+#include "convexHull3D.hpp"
 #include "star.hpp"
-#include "triangle.hpp"
 
 namespace CompGeom {
   class StarHull {
 
   private:
-    std::vector < Star > current;
-    std::vector < std::vector < Star > > old; 
-    const Geometry geom;
+    TraceFile file;
 
   public:
-    StarHull ( const Geometry & geom ) : current{}, old{}, geom{geom} {}
-
-    template < typename inputIt >
-    void update ( const inputIt start, const inputIt end ) {
-      if ( !current.empty() ) old.push_back(current);
-      current.assign(start,end);
-    }
+    template < typename G >
+    StarHull ( const G & geom, const std::string &file_name )
+      : file { file_name, "CONVEX HULL", geom } {}
 
-    void print ( const std::string &file_name );
+    void update ( StarArena &stars );
   };
 
+  inline void StarHull::update ( StarArena &stars ) {
+    if ( !file.is_open() ) return;
 
-  inline void StarHull::print ( const std::string & file_name ) {
-    std::ofstream file ( file_name );
-    file << "META DATA" << std::endl;
-    file << "TYPE\tCONVEX HULL" << std::endl;
-    file << "Number of Points " << geom.size() << std::endl;
-    file << "Number of Timesteps " << old.size() << std::endl;
-    file << std::endl << std::endl;
-    
-    for ( size_t i=0; i<geom.size(); i++ ) {
-      file << "POINT " << i << " " << geom[i] << std::endl;
+    // Stars that don't agree yet can repeat a triangle
+    std::set < std::array < size_t, 3 > > tri_list;
+    for ( size_t s=0; s<stars.size(); s++ ) {
+      const Star star = stars[s];
+      if ( !star.alive() ) continue;
+      for ( size_t j=0; j<star.size(); j++ ) {
+	std::array < size_t, 3 > tri = {{ star.id(), star[j], star[(j+1)%star.size()] }};
+	std::rotate ( tri.begin(), std::min_element ( tri.begin(), tri.end() ), tri.end() );
+	tri_list.insert ( tri );
+      }
     }
-    file << std::endl << std::endl;
-    
+
+    std::ostream &out = file.step();
+    out << "Number of Triangles " << tri_list.size() << "\n";
     size_t count = 0;
-    for ( size_t si=0; si<old.size(); si++ ) {
-      const auto & star_list = old[si];
-      std::set<Triangle> tri_list;
-      for ( auto star : star_list ) {
-	tri_list.insert ( Triangle( star.id, star.back(), star.front(),geom ) );
-	for ( size_t j = 0; j<star.size()-1; j++ ) {
-	  tri_list.insert ( Triangle( star.id, star[j], star[j+1],geom ) );
-	}
-      }
-      
-      
-      file << "#################################" << std::endl;
-      file << "Timestep " << count++ << std::endl;
-      file << "Number of Triangles " << tri_list.size() << std::endl;
-      size_t count = 0;
-      for ( const auto & tri : tri_list )  {
-	file << "Triangle " << count++ << " " << tri[0] << " " << tri[1] << " " << tri[2] << std::endl;;
-      }
-      file << std::endl << std::endl;
-    
-      file << "Number of Stars " << star_list.size() << std::endl;
-      for ( size_t i=0; i<star_list.size(); i++ ) {
-	const auto & star = star_list[i];
-	file << "Star " << i << " " << "alive " << star.id << " ";
-	for ( const auto &edge : star ) file << edge << " ";
-	file << std::endl;
-      }
-      file << std::endl << std::endl;
+    for ( const auto & tri : tri_list )  {
+      out << "Triangle " << count++ << " " << tri[0] << " " << tri[1] << " " << tri[2] << "\n";
+    }
+    out << "\n\n";
+
+    out << "Number of Stars " << stars.size() << "\n";
+    for ( size_t i=0; i<stars.size(); i++ ) {
+      const Star star = stars[i];
+      out << "Star " << i << " " << ( star.alive() ? "alive " : "dead " ) << star.id() << " ";
+      for ( const auto &edge : star ) out << edge << " ";
+      out << "\n";
     }
   }
 }
-
-
@@ -0,0 +1,62 @@
+/******************************************************
+ * Name    : starSet.hpp
+ * Author  : Kevin Mooney
+ * Created : 17/10/26
+ * Updated :
+ *
+ * Description:
+ *   The stars of every point during star splaying, the
+ *   queue of stars still to be checked and the points
+ *   each round finds outside the hull
+ *
+ * NOTES:
+ *   - All of them are kept in a HullWorkspace, reset()
+ *     sizes the stars and the queue for the next hull
+ *     without giving back their memory
+ ******************************************************/
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "star.hpp"
+
+#define NOSTAR 0xFFFFFFFFu	// Point without a star
+
+namespace CompGeom {
+
+  // star[i] is the index in the arena of the star of point i, or NOSTAR
+  struct StarSet {
+    StarArena		       stars;
+    std::vector < uint32_t > star;
+
+    void reset ( size_t nPoints ) { stars.clear(); star.assign ( nPoints, NOSTAR ); }
+
+    Star operator[] ( size_t id ) { return stars[star[id]]; }
+    bool has        ( size_t id ) const { return star[id] != NOSTAR; }
+    Star add        ( uint32_t id ) { star[id] = stars.size(); return stars.add ( id ); }
+    Star add        ( const Star &s ) { star[s.id()] = stars.size(); return stars.add ( s ); }
+  };
+
+  // Queue of stars that need checking, each star is queued at most once
+  class SplayQueue {
+  private:
+    std::vector < size_t > _queue;
+    std::vector < char   > _queued;
+
+  public:
+    void reset ( size_t nPoints ) { _queue.clear(); _queued.assign ( nPoints, 0 ); }
+
+    void push ( size_t id ) { if ( !_queued[id] ) { _queued[id] = 1; _queue.push_back ( id ); } }
+    template < typename T > void pushAll ( const T &ids ) { for ( auto id : ids ) push ( id ); }
+    bool empty () const { return _queue.empty(); }
+    size_t pop () { size_t id = _queue.back(); _queue.pop_back(); _queued[id] = 0; return id; }
+  };
+
+  // Plane of a hull triangle, p is in front if normal . (p - origin) > 0
+  struct HullPlane { double normal[3]; double origin[3]; };
+
+  // A point outside the hull and a triangle of the hull it can see
+  struct OutsidePoint { size_t id; uint32_t tri[3]; };
+}
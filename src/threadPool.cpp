@@ -0,0 +1,141 @@
+/******************************************************
+ * Name    : threadPool.cpp
+ * Author  : Kevin Mooney
+ * Created : 17/10/26
+ * Updated :
+ *
+ * Description:
+ *   Workers of the work stealing thread pool
+ *
+ * NOTES:
+ ******************************************************/
+
+#include "parallel.hpp"
+#include "threadPool.hpp"
+
+using namespace CompGeom;
+
+static thread_local bool inTask = false;
+
+// Sets inTask while alive and gives back the value it had before, even
+// if the work throws
+class InTaskGuard {
+private:
+  bool _previous;
+
+public:
+  InTaskGuard  () : _previous ( inTask ) { inTask = true; }
+  ~InTaskGuard () { inTask = _previous; }
+
+  InTaskGuard ( const InTaskGuard & ) = delete;
+  InTaskGuard &operator= ( const InTaskGuard & ) = delete;
+};
+
+ThreadPool::ThreadPool ( size_t nWorkers )
+  : _queues     { new Queue [ std::max < size_t > ( nWorkers, 1 ) ] }
+  , _generation {0}
+  , _busy       {0}
+  , _stop       {false}
+{
+  for ( size_t w=1; w<nWorkers; w++ ) _threads.emplace_back ( [this,w] () { thread ( w ); } );
+}
+
+ThreadPool::~ThreadPool () {
+  {
+    std::lock_guard < std::mutex > guard ( _mutex );
+    _stop = true;
+  }
+  _wake.notify_all();
+  for ( auto &t : _threads ) t.join();
+}
+
+// Takes the next task of worker's own queue, or steals the last
+// task of another
+bool ThreadPool::next ( size_t worker, size_t &task ) {
+  const size_t nw = size();
+  {
+    Queue &own = _queues[worker];
+    std::lock_guard < std::mutex > guard ( own.lock );
+    if ( !own.tasks.empty() ) {
+      task = own.tasks.front();
+      own.tasks.pop_front();
+      return true;
+    }
+  }
+  for ( size_t i=1; i<nw; i++ ) {
+    Queue &victim = _queues[(worker+i)%nw];
+    std::lock_guard < std::mutex > guard ( victim.lock );
+    if ( !victim.tasks.empty() ) {
+      task = victim.tasks.back();
+      victim.tasks.pop_back();
+      return true;
+    }
+  }
+  return false;
+}
+
+// No tasks are added during a job, so once every queue is empty
+// the worker is finished
+void ThreadPool::work ( size_t worker ) {
+  size_t      task;
+  InTaskGuard inside;
+  while ( next ( worker, task ) ) {
+    try {
+      _job ( task, worker );
+    }
+    catch ( ... ) {
+      std::lock_guard < std::mutex > guard ( _mutex );
+      if ( !_error ) _error = std::current_exception();
+    }
+  }
+}
+
+bool ThreadPool::working () { return inTask; }
+
+void ThreadPool::thread ( size_t worker ) {
+  size_t seen = 0;
+  while ( true ) {
+    {
+      std::unique_lock < std::mutex > lock ( _mutex );
+      _wake.wait ( lock, [&] () { return _stop || _generation != seen; } );
+      if ( _stop ) return;
+      seen = _generation;
+    }
+    work ( worker );
+    {
+      std::lock_guard < std::mutex > guard ( _mutex );
+      if ( --_busy == 0 ) _done.notify_one();
+    }
+  }
+}
+
+// Wakes the pool on the queued tasks, works alongside it and waits
+// for it to finish
+void ThreadPool::execute () {
+  {
+    std::lock_guard < std::mutex > guard ( _mutex );
+    _busy  = _threads.size();
+    _error = nullptr;
+    _generation++;
+  }
+  _wake.notify_all();
+  work ( 0 );
+
+  std::exception_ptr error;
+  {
+    std::unique_lock < std::mutex > lock ( _mutex );
+    _done.wait ( lock, [&] () { return _busy == 0; } );
+    std::swap ( error, _error );
+  }
+  _job = nullptr;
+  if ( error ) std::rethrow_exception ( error );
+}
+
+std::shared_ptr < ThreadPool > CompGeom::threadPool () {
+  static std::mutex                     lock;
+  static std::shared_ptr < ThreadPool > pool;
+
+  std::lock_guard < std::mutex > guard ( lock );
+  if ( !pool || pool->size() != numThreads() ) pool = std::make_shared < ThreadPool > ( numThreads() );
+  return pool;
+}
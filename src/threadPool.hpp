@@ -0,0 +1,98 @@
+/******************************************************
+ * Name    : threadPool.hpp
+ * Author  : Kevin Mooney
+ * Created : 17/10/26
+ * Updated :
+ *
+ * Description:
+ *   Work stealing pool of cpu threads for loops whose
+ *   iterations take very different amounts of time
+ *
+ * NOTES:
+ *   - Each worker starts with a contiguous block of the
+ *     tasks, taking them from the front of its queue.
+ *     When it runs out it steals from the back of the
+ *     other queues
+ *   - The calling thread is worker 0, the pool has
+ *     size()-1 threads of its own
+ *   - run() isn't reentrant, f must not call run() on
+ *     the same pool. Calls from different threads wait
+ *     for each other
+ *   - An exception thrown by f is rethrown from run()
+ *     once every worker has stopped
+ ******************************************************/
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace CompGeom {
+
+  class ThreadPool {
+  private:
+    struct Queue {
+      std::mutex          lock;
+      std::deque < size_t > tasks;
+    };
+
+    std::vector < std::thread >	 _threads;
+    std::unique_ptr < Queue[] >	 _queues;	// One per worker
+    std::function < void ( size_t, size_t ) > _job;
+
+    std::mutex			 _runLock;	// Held for the whole of run()
+    std::mutex			 _mutex;	// Guards everything below
+    std::condition_variable	 _wake;
+    std::condition_variable	 _done;
+    size_t			 _generation;	// Number of jobs started
+    size_t			 _busy;		// Threads still working on the job
+    bool			 _stop;
+    std::exception_ptr		 _error;
+
+    bool next   ( size_t worker, size_t &task );
+    void work   ( size_t worker );
+    void thread ( size_t worker );
+    void execute ();
+
+  public:
+    explicit ThreadPool ( size_t nWorkers );
+    ~ThreadPool ();
+
+    ThreadPool ( const ThreadPool & )            = delete;
+    ThreadPool &operator= ( const ThreadPool & ) = delete;
+
+    size_t size () const { return _threads.size() + 1; }
+
+    // True on a thread working on a task of any pool
+    static bool working ();
+
+    // Calls f(task,worker) for every task in [0,nTasks), worker < size()
+    // is the thread calling, so can index per thread buffers
+    template < typename Func >
+    void run ( size_t nTasks, Func f );
+  };
+
+  // Pool shared by the cpu algorithms, remade when numThreads() changes.
+  // Hold on to the pointer for as long as the pool is used, a pool that
+  // is replaced lives on until its last holder lets go
+  std::shared_ptr < ThreadPool > threadPool ();
+
+  template < typename Func >
+  void ThreadPool::run ( size_t nTasks, Func f ) {
+    std::lock_guard < std::mutex > running ( _runLock );
+
+    const size_t nw = size();
+    for ( size_t w=0; w<nw; w++ ) {
+      std::lock_guard < std::mutex > guard ( _queues[w].lock );
+      for ( size_t t = w*nTasks/nw; t < (w+1)*nTasks/nw; t++ ) _queues[w].tasks.push_back ( t );
+    }
+    _job = f;
+    execute();
+  }
+}
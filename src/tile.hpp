@@ -2,43 +2,93 @@
  * Name    : tile.hpp
  * Author  : Kevin Mooney
  * Created : 25/07/16
- * Updated :
+ * Updated : 17/10/26
  *
  * Description:
  *
  * NOTES:
+ *   - A pixel is one 8 byte word, the bits of the
+ *     distance in the high half and the point id in the
+ *     low half. Projecting keeps the smallest word with
+ *     an atomic min straight on the tile, so nothing else
+ *     is stored per pixel
+ *   - Point ids are 32 bits, noID() marks an empty pixel
+ *   - A tile of length 0 holds no memory, see BoundingBox
  ******************************************************/
 
 #pragma once
 
 #include <algorithm>
+#include <atomic>
+#include <cstdint>
 #include <cstdio>
+#include <cstring>
 #include <limits>
+#include <vector>
 
+#include "alignedAllocator.hpp"
 #include "directionEnums.hpp"
 
 namespace CompGeom {
   class Tile {
+  public:
+    typedef std::atomic < uint64_t > Cell;
+
   private:
-    std::vector < float  > _VF;
-    std::vector < size_t > _VIDS;
+    std::vector < Cell, AlignedAllocator < Cell > > _cells;
     const size_t	   _length;
 
-    float  maxfloat() const { return std::numeric_limits<float>::max(); }
-    size_t maxID()    const { return std::numeric_limits<size_t>::max(); }
+    static float    maxfloat() { return std::numeric_limits<float   >::max(); }
     size_t index(const size_t &i, const size_t &j) const {return j + i*_length;}
 
+    uint64_t word ( size_t i, size_t j ) const { return _cells[index(i,j)].load ( std::memory_order_relaxed ); }
+
   public:
     Tile ( size_t length )
-      : _VF  {std::vector<float >(length*length, maxfloat())} 
-      , _VIDS{std::vector<size_t>(length*length, maxID()   )}
+      : _cells (length*length)
       , _length{length}
-    {}
+    {
+      for ( auto &c : _cells ) c.store ( empty(), std::memory_order_relaxed );
+    }
+
+    static uint32_t noID    () { return std::numeric_limits<uint32_t>::max(); }
+
+    // Distances are non-negative so their bits sort the same way as the
+    // floats, the smallest word is the closest point and on equal distances
+    // the lowest id
+    static uint64_t pack ( float dist, uint32_t id ) {
+      uint32_t bits;
+      memcpy ( &bits, &dist, sizeof(bits) );
+      return (uint64_t(bits) << 32) | id;
+    }
+    static float distance ( uint64_t w ) {
+      const uint32_t bits = w >> 32;
+      float          dist;
+      memcpy ( &dist, &bits, sizeof(dist) );
+      return dist;
+    }
+    // Word of an empty pixel, bigger than that of any point
+    static uint64_t empty () { return pack ( maxfloat(), noID() ); }
+
+    float    get    ( size_t i, size_t j		) const	{ return distance ( word(i,j) );	}
+    uint32_t getID  ( size_t i, size_t j		) const	{ return word(i,j) & 0xFFFFFFFF;	}
+    void     set    ( size_t i, size_t j, float val)	{ setCell ( i, j, val, getID(i,j) );	}
+    void     setID  ( size_t i, size_t j, uint32_t id)	{ setCell ( i, j, get(i,j), id );	}
+    void     setCell( size_t i, size_t j, float val, uint32_t id ) {
+      _cells[index(i,j)].store ( pack(val,id), std::memory_order_relaxed );
+    }
+    void     clear  ( size_t i, size_t j		)	{ _cells[index(i,j)].store ( empty(), std::memory_order_relaxed ); }
 
-    float  get   ( size_t i, size_t j		) const	{ return _VF[index(i,j)];	}
-    size_t getID ( size_t i, size_t j		) const	{ return _VIDS[index(i,j)];	}
-    void   set   ( size_t i, size_t j, float val)	{ _VF  [index(i,j)] = val;	}
-    void   setID ( size_t i, size_t j, size_t id)	{ _VIDS[index(i,j)] = id;	}
+    // Keeps the smaller of pixel i*length()+j and w, thread safe. Returns
+    // true if the pixel was empty before
+    bool     keepMin( size_t pixel, uint64_t w ) {
+      uint64_t current = _cells[pixel].load ( std::memory_order_relaxed );
+      while ( w < current ) {
+	if ( _cells[pixel].compare_exchange_weak ( current, w, std::memory_order_relaxed ) )
+	  return current == empty();
+      }
+      return false;
+    }
 
     size_t length	() const { return _length;	}
     size_t nCols	() const { return _length;	}
@@ -48,8 +98,9 @@ namespace CompGeom {
       for ( size_t i=0; i<_length; i++ ) {
 	for ( size_t j=0; j<_length; j++ ) {
 	  size_t	id = index(i,j);
-	  if ( _VF[id] == maxfloat() ) printf(" -  "         ); 
-	  else                       printf("%3.1f ",_VF[id]);
+	  const float d  = distance ( _cells[id].load ( std::memory_order_relaxed ) );
+	  if ( d == maxfloat() ) printf(" -  "       );
+	  else                   printf("%3.1f ",d);
 	}
 	printf("\n"); fflush(stdout);
       }
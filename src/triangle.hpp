@@ -2,96 +2,115 @@
  * Name    : triangle.hpp
  * Author  : Kevin Mooney
  * Created : 17/07/16
- * Updated : 
+ * Updated : 17/10/26
  *
  * Description:
  *   Rewrite of face.hpp, stores indexes of vertices
- *   corresponding to geometry as well as norm, com 
- *   and offset d
+ *   corresponding to geometry as well as the plane
+ *   they lie in
  *
  *   Equation of plane is n0*x0 + n1*x1 + n2*x2 + d = 0
+ *
+ * NOTES:
+ *   - A plain 32 byte record, three 32 bit ids and the
+ *     plane (n0,n1,n2,d). Nothing is allocated, so
+ *     triangles can be copied and stored in arrays
+ *   - d is found from the centre of mass, which is then
+ *     discarded
  * ToDo:
  ******************************************************/
 
 #pragma once
 
 #include <algorithm>
-#include <vector>
+#include <array>
+#include <cstdint>
+#include <type_traits>
 
 #include "errorMessages.hpp"
+#include "geometry.hpp"
 #include "point.hpp"
+#include "points.hpp"
 
 namespace CompGeom {
-  
-  class Triangle {
-    
+
+  class alignas(16) Triangle {
+
   private:
-    std::vector<size_t> _vertices;
-    Point _norm;
-    Point _com;
+    uint32_t _vertices[3];
+    float    _plane[4];		// n0, n1, n2, d
+
+    void setPlane ( const Vec3 &p0, const Vec3 &p1, const Vec3 &p2 ) {
+      const Vec3 n   = cross ( p1 - p0, p2 - p0 );
+      const Vec3 com = { (p0.x + p1.x + p2.x)/3, (p0.y + p1.y + p2.y)/3, (p0.z + p1.z + p2.z)/3 };
+      _plane[0] = n.x;
+      _plane[1] = n.y;
+      _plane[2] = n.z;
+      _plane[3] = -dot ( n, com );
+    }
+
+    static Vec3 vec3 ( const Point &p ) { return { p[0], p[1], p[2] }; }
 
   public:
-    // The norm and centre of mass are calculated on construction 
-    // and then all points are discarded except for their IDS
-    Triangle ( size_t id0, size_t id1, size_t id2, const Geometry &geom) : 
-      _vertices{{id0,id1,id2}}, 
-      _norm{Point(3)}, 
-      _com {Point(3)} 
-    { 
-
-      const Point &p0 = geom[id0], &p1 = geom[id1], &p2 = geom[id2];
-      _com  = Point { { (p0[0] + p1[0] + p2[0])/3, 
-      			(p0[1] + p1[1] + p2[1])/3, 
-      			(p0[2] + p1[2] + p2[2])/3 } };
-
-      Point x ( p1 - p0 ), y ( p2 - p0 );
-      _norm = Point { { x[1]*y[2] - x[2]*y[1], 
-			x[2]*y[0] - x[0]*y[2], 
-			x[0]*y[1] - x[1]*y[0] } };
+    // The plane is calculated on construction and then
+    // all points are discarded except for their IDS
+    Triangle ( size_t id0, size_t id1, size_t id2, const Geometry &geom ) :
+      _vertices{ uint32_t(id0), uint32_t(id1), uint32_t(id2) }
+    {
+      setPlane ( vec3 ( geom[id0] ), vec3 ( geom[id1] ), vec3 ( geom[id2] ) );
+    }
+
+    // Same as above reading the vertices straight out of the arrays
+    Triangle ( size_t id0, size_t id1, size_t id2, const Points<3> &pts ) :
+      _vertices{ uint32_t(id0), uint32_t(id1), uint32_t(id2) }
+    {
+      setPlane ( pts[id0], pts[id1], pts[id2] );
     }
-    ~Triangle() {}
-    
+
     // Operator overloading
-    size_t operator   [](int i) const  {return _vertices[i];}
+    uint32_t operator [](int i) const  {return _vertices[i];}
 
     // Points are stored in anti-clockwise order when viewing from the norm
-    inline Point normal () const {
-      return _norm;
-    }
-    
-    // Return centre of mass
-    inline Point com () const {
-      return _com;
+    Point normal () const {
+      return Point { { _plane[0], _plane[1], _plane[2] } };
     }
 
-    // Checks if point is visible from the triangle
-    bool isVisible ( Point p ) const  {
-      const Point &n = _norm;
-      const Point &v = _com;
-      return n[0]*(p[0] - v[0]) + n[1]*(p[1] - v[1]) + n[2]*(p[2] - v[2]) > 0;
+    // d in the equation of the plane
+    float offset () const { return _plane[3]; }
+
+    // (n0,n1,n2,d), as planeSide in predicates.hpp takes it
+    const float *plane () const { return _plane; }
+
+    // Checks if point p is visible from the triangle
+    bool isVisible ( const Vec3 &p ) const  {
+      return _plane[0]*p.x + _plane[1]*p.y + _plane[2]*p.z + _plane[3] > 0;
     }
+    bool isVisible ( const Point &p ) const { return isVisible ( vec3 ( p ) ); }
 
     void invert () {
       std::swap ( _vertices[1], _vertices[2] );
-      _norm = - _norm;		// This might be inefficient
+      for ( auto &c : _plane ) c = -c;
     }
-    
+
   };
 
-  inline bool operator< ( Triangle ti, Triangle tj ) {
-    std::vector<size_t> temp1 = { ti[0], ti[1], ti[2] };
-    std::vector<size_t> temp2 = { tj[0], tj[1], tj[2] };
-    sort ( temp1.begin(), temp1.end() );
-    sort ( temp2.begin(), temp2.end() );
+  static_assert ( sizeof(Triangle) == 32, "Triangle should fill 32 bytes" );
+  static_assert ( std::is_trivially_copyable < Triangle >::value, "Triangle should be copied as bytes" );
+
+  inline bool operator< ( const Triangle &ti, const Triangle &tj ) {
+    std::array < uint32_t, 3 > temp1 = {{ ti[0], ti[1], ti[2] }};
+    std::array < uint32_t, 3 > temp2 = {{ tj[0], tj[1], tj[2] }};
+    std::sort ( temp1.begin(), temp1.end() );
+    std::sort ( temp2.begin(), temp2.end() );
 
     return temp1 < temp2;
   }
 
-  inline bool operator== ( Triangle ti, Triangle tj ) {
-    return (ti[0] == tj[0] && ti[1] == tj[1] && ti[2] == tj[2]) || 
+  inline bool operator== ( const Triangle &ti, const Triangle &tj ) {
+    return (ti[0] == tj[0] && ti[1] == tj[1] && ti[2] == tj[2]) ||
            (ti[0] == tj[1] && ti[1] == tj[2] && ti[2] == tj[0]) ||
            (ti[0] == tj[2] && ti[1] == tj[0] && ti[2] == tj[1]);
-      
+
   }
 }
 
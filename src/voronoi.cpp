@@ -12,6 +12,7 @@
 #include <iostream>
 #include <set>
 
+#include "errorMessages.hpp"
 #include "pba2D.h"
 #include "tile.hpp"
 #include "voronoi.hpp"
@@ -27,8 +28,16 @@ static int shortID ( int i, int j , int w) {
   return 2*(i*w + j);
 }
 
+VoronoiEngine voronoiEngine ( const string &name ) {
+  if      ( name == "pbaGPU" ) return PBA_GPU;
+  else if ( name == "pbaCPU" ) return PBA_CPU;
+  else if ( name == "edtCPU" ) return EDT_CPU;
+  errorM("Don't recognise Voronoi engine");
+  return DEFAULT_VORONOI_ENGINE;
+}
+
 // Returns true if any nearest neighbour is not set to MARKER
-bool isNearestNeighbourOn( short *V, size_t i, size_t j,size_t w ) {
+bool isNearestNeighbourOn( const short *V, size_t i, size_t j,size_t w ) {
   vector<vector<int>> dir = {{-1,-1},{-1,0},{-1,1},
 			     {0 ,-1},{0 ,0},{0 ,1},
 			     {1 ,-1},{1 ,0},{1 ,1}};
@@ -44,19 +53,18 @@ bool isNearestNeighbourOn( short *V, size_t i, size_t j,size_t w ) {
 
 // Stolen from Rosetta Code
 // Creates a portable bitmap file with a Voronoi diagram
-void makeVoronoiPBM( short * V, short * In, size_t w, size_t h, const string &filename ) {  
-  size_t i, j;
+void makeVoronoiPBM( const Voronoi &V, const Voronoi &In, const string &filename ) {
+  size_t i, j, w = V.length(), h = V.length();
   FILE *fp = fopen(filename.c_str(), "wb"); /* b - binary mode */
   fprintf(fp, "P6\n%lu %lu\n255\n", w, h);
   for (i = 0; i < w; ++i) {
     for (j = 0; j < h; ++j) {
-      int index = shortID(i,j,w);
       static unsigned char color[3];
-      if ( isNearestNeighbourOn(In,i,j,w) ) {
+      if ( isNearestNeighbourOn(In.data(),i,j,w) ) {
 	color[0] = color[1] = color[2] = 0;
       }
       else {
-	srand(V[index]*V[index+1]);
+	srand(V(i,j).x*V(i,j).y);
 	color[0] = rand()   % 256;  /* red */
 	color[1] = rand()   % 256;  /* green */
 	color[2] = rand()   % 256;  /* blue */
@@ -72,11 +80,12 @@ void makeVoronoiPBM( const Voronoi &V, const string &filename ) {
   FILE *fp = fopen(filename.c_str(), "wb"); /* b - binary mode */
   fprintf(fp, "P6\n%lu %lu\n255\n", V.size(), V.size());
   std::set<int> cols;
-  for ( auto row : V ) {
-    for ( auto p : row ) {
+  for ( size_t i=0; i<V.size(); i++ ) {
+    for ( size_t j=0; j<V.size(); j++ ) {
+      const Short2 p = V(i,j);
       vector < unsigned char > colour(3);
-      // srand(p[0]+V.size()*p[1]);
-      int base = p[0] + V.size()*p[1];
+      // srand(p.x+V.size()*p.y);
+      int base = p.x + V.size()*p.y;
       // colour[0] = rand()   % 256;  /* red */
       // colour[1] = rand()   % 256;  /* green */
       // colour[2] = rand()   % 256;  /* blue */
@@ -92,15 +101,16 @@ void makeVoronoiPBM( const Voronoi &V, const string &filename ) {
 }
 
 
-void makeVoronoiPBM( const Voronoi &V, const string &filename, CompGeom::Tile &T) {  
+void makeVoronoiPBM( const Voronoi &V, const string &filename, const CompGeom::Tile &T) {
   FILE *fp = fopen(filename.c_str(), "wb"); /* b - binary mode */
   fprintf(fp, "P6\n%lu %lu\n255\n", V.size(), V.size());
   std::set<int> cols;
-  for ( auto row : V ) {
-    for ( auto p : row ) {
+  for ( size_t i=0; i<V.size(); i++ ) {
+    for ( size_t j=0; j<V.size(); j++ ) {
+      const Short2 p = V(i,j);
       vector < unsigned char > colour(4,0);
-      srand48(T.getID(p[1],p[0]));
-      // cout << T.getID(p[1],p[0]) << " ";
+      srand48(T.getID(p.y,p.x));
+      // cout << T.getID(p.y,p.x) << " ";
       // int base = rand();
       colour[0] = drand48()*256;
       colour[1] = drand48()*256;
@@ -16,12 +16,59 @@
 
 #include "tile.hpp"
 
-typedef std::vector < std::vector < short > > VoronoiRow;
-typedef std::vector < std::vector < std::vector < short > > > Voronoi;
+// Backends for computing the discrete Voronoi diagram of a tile
+//  - PBA_GPU : Parallel Banding Algorithm on the card (lib/pba2DHost.cu)
+//  - PBA_CPU : Port of the same algorithm to cpu threads (pba2DCpu.hpp)
+//  - EDT_CPU : Separable exact distance transform on cpu threads (edt2DCpu.hpp)
+enum VoronoiEngine { PBA_GPU, PBA_CPU, EDT_CPU };
+
+// Compiling with -DPBA_CPU_ONLY removes the need for a card in gHullSerial
+#ifdef PBA_CPU_ONLY
+const VoronoiEngine DEFAULT_VORONOI_ENGINE = PBA_CPU;
+#else
+const VoronoiEngine DEFAULT_VORONOI_ENGINE = PBA_GPU;
+#endif
+
+// Converts the names used on the command line, i.e. "pbaGPU", "pbaCPU" or "edtCPU"
+VoronoiEngine voronoiEngine ( const std::string &name );
+
+// A pixel of a Voronoi texture, same layout as the cuda short2
+struct Short2 {
+  short x, y;
+  bool operator==( const Short2 &o ) const { return x == o.x && y == o.y; }
+  bool operator!=( const Short2 &o ) const { return !(*this == o);      }
+};
+
+// Square texture of short pairs stored the same way as the input and
+// output of pba2DVoronoiDiagram, so the engines read and write it directly
+class Voronoi {
+private:
+  std::vector < short > _data;
+  size_t                _length;
+
+public:
+  explicit Voronoi ( size_t length = 0 ) : _data(2*length*length), _length{length} {}
+
+  size_t length() const { return _length; }
+  size_t size  () const { return _length; }
+
+  // Pixel (i,j) is the pair at 2*(i*length + j)
+  Short2 operator()( size_t i, size_t j ) const {
+    const short *p = &_data[2*(i*_length + j)];
+    return Short2 { p[0], p[1] };
+  }
+  void set ( size_t i, size_t j, short x, short y ) {
+    _data[2*(i*_length + j)  ] = x;
+    _data[2*(i*_length + j)+1] = y;
+  }
+
+  short       *data()       { return _data.data(); }
+  const short *data() const { return _data.data(); }
+};
 
 // Stolen from Rosetta Code
 // Creates a portable bitmap file with a Voronoi diagram
-void makeVoronoiPBM( short * V, short * In, size_t w, size_t h, const std::string &filename );
+void makeVoronoiPBM( const Voronoi &V, const Voronoi &In, const std::string &filename );
 void makeVoronoiPBM( const Voronoi &V, const std::string &filename );
-void makeVoronoiPBM( const Voronoi &V, const std::string &filename, CompGeom::Tile &T );
+void makeVoronoiPBM( const Voronoi &V, const std::string &filename, const CompGeom::Tile &T );
 
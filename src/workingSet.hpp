@@ -2,17 +2,58 @@
  * Name    : workingSet.hpp
  * Author  : Kevin Mooney
  * Created : 17/08/16
- * Updated : 
+ * Updated : 17/10/26
  *
  * Description:
+ *   The working set of a star is the list of points
+ *   joined to it by an edge of the dual of a Voronoi
+ *   diagram
  *
  * NOTES:
+ *   - All working sets are kept in compressed sparse
+ *     row form, set i has star ids[i] and neighbours
+ *     [offsets[i],offsets[i+1])
+ *   - WorkingSetSpan doesn't own its neighbours, it is
+ *     only valid as long as the storage it points into
  ******************************************************/
 
-#include <vector>
+#pragma once
 
-#include "orderedEdge.hpp"
+#include <cstdint>
+#include <vector>
 
 namespace CompGeom {
-  typedef std::vector < OrderedEdge > WorkingSet;
+
+  // The working set of one star
+  struct WorkingSetSpan {
+    size_t          id;		// Id of the star
+    const uint32_t *first;	// Neighbours of the star
+    const uint32_t *last;
+
+    typedef const uint32_t *const_iterator;
+    const_iterator begin() const { return first; }
+    const_iterator end  () const { return last;  }
+
+    size_t   size () const            { return last - first; }
+    bool     empty() const            { return first == last; }
+    uint32_t operator[](size_t i) const { return first[i]; }
+  };
+
+  class WorkingSets {
+  public:
+    std::vector < uint32_t > ids;	 // Star id of each set
+    std::vector < size_t   > offsets;	 // Start of each set in neighbours, plus the end
+    std::vector < uint32_t > neighbours;
+
+    size_t size () const { return ids.size(); }
+    bool   empty() const { return ids.empty(); }
+
+    // Keeps the memory for the next use
+    void clear() { ids.clear(); offsets.clear(); neighbours.clear(); }
+
+    WorkingSetSpan operator[](size_t i) const {
+      const uint32_t *base = neighbours.data();
+      return WorkingSetSpan { ids[i], base + offsets[i], base + offsets[i+1] };
+    }
+  };
 }
@@ -1,6 +1,10 @@
 #include <algorithm>
 #include <cmath>
+#include <fstream>
 #include <iostream>
+#include <limits>
+#include <random>
+#include <set>
 #include <vector>
 
 #include "wvtest.h"
@@ -13,14 +17,30 @@
 #include "../src/orderedEdge.hpp"
 #include "../src/convexHull2D.hpp"
 #include "../src/insertion3D.hpp"
+#include "../src/facePool.hpp"
+#include "../src/hullMesh.hpp"
+#include "../src/parallelHull3D.hpp"
+#include "../src/quickHull3D.hpp"
+#include "../src/randomizedHull3D.hpp"
+#include "../src/convexHull3D.hpp"
 #include "../src/tile.hpp"
 #include "../src/boundingBox.hpp"
+#include "../src/hullWorkspace.hpp"
 #include "../src/workingSet.hpp"
+#include "../src/points.hpp"
 
 #include "cudaHull.hpp"
 #include "gHullSerial.hpp"
 #include "geometryHelper.hpp"
+#include "pba2D.h"
+#include "pba2DCpu.hpp"
+#include "parallel.hpp"
+#include "radixSort.hpp"
+#include "edt2DCpu.hpp"
 #include "star.hpp"
+#include "threadPool.hpp"
+#include "predicates.hpp"
+#include "exactPredicates.hpp"
 
 #define EPS 0.00001f
 #define WVPASSNEAR(a,b) WVPASS ( fabs(a-b) < fabs(a)*EPS + EPS )
@@ -83,6 +103,37 @@ WVTEST_MAIN("Geometry Class") {
   WVPASS ( failed );
 }
 
+WVTEST_MAIN("Points Class") {
+  CompGeom::Geometry G { {0,0,0}, {1,2,3}, {4,5,6}, {1,1,1} };
+  CompGeom::Points<3> P ( G );
+  WVPASS ( P.size() == 4 );
+  WVPASS ( P.dim()  == 3 );
+  for ( size_t i=0; i<G.size(); i++ ) {
+    const CompGeom::Vec3 p = P[i];
+    WVPASS ( p.x == G[i][0] && p.y == G[i][1] && p.z == G[i][2] );
+    WVPASS ( P.x(i) == G[i][0] && P.y(i) == G[i][1] && P.z(i) == G[i][2] );
+  }
+
+  // Each axis is its own aligned array
+  for ( size_t a=0; a<3; a++ ) {
+    WVPASS ( reinterpret_cast < uintptr_t > ( P.axis(a) ) % CACHELINE == 0 );
+    WVPASS ( P.axis(a)[1] == G[1][a] );
+  }
+
+  P.push_back ( CompGeom::Vec3 { 7,8,9 } );
+  WVPASS ( P.size() == 5 );
+  WVPASS ( P.z(4) == 9 );
+
+  // The dimension has to match the template, unless it is dynamic
+  bool failed = false;
+  try { CompGeom::Points<2> Q ( G ); } catch ( const std::exception& ) { failed = true; }
+  WVPASS ( failed );
+
+  CompGeom::Points<DYNAMICDIM> D ( G );
+  WVPASS ( D.dim() == 3 );
+  WVPASS ( D.coord ( 2, 1 ) == 5 );
+}
+
 WVTEST_MAIN("Face Class") {
   // Check constructor
   CompGeom::Point p1{{0,0,0}}, p2{{1,1,0}}, p3{{1,0,0}};  
@@ -110,9 +161,9 @@ WVTEST_MAIN("Triangle Class") {
   WVPASS ( T[1] == 1 );
   WVPASS ( T[2] == 2 );
 
-  CompGeom::Point norm { {0,0,-1} }, com { {2.0/3.0, 1.0/3.0, 0} };
+  CompGeom::Point norm { {0,0,-1} };
   WVPASS ( norm == T.normal() );
-  WVPASS ( com  == T.com()    );
+  WVPASSNEAR ( T.offset(), 0 );
 
   // Check isVisible function
   CompGeom::Point q1{{1,1,1}}, q2{{1,3,-1}};
@@ -125,6 +176,25 @@ WVTEST_MAIN("Triangle Class") {
   WVPASS ( T[0] == 0 );
   WVPASS ( T[1] == 2 );
   WVPASS ( T[2] == 1 );  
+
+  // Inverting flips the whole plane
+  WVPASS ( -norm == T.normal() );
+  WVPASSNEAR ( T.offset(), 0 );
+
+  // Made from arrays of points
+  CompGeom::Points<3> P ( G );
+  CompGeom::Triangle U ( 0,1,2,P );
+  WVPASS ( norm == U.normal() );
+  WVPASS (  U.isVisible( CompGeom::Vec3 { 1,3,-1 } ) );
+  WVPASS ( !U.isVisible( CompGeom::Vec3 { 1,1, 1 } ) );
+  WVPASS ( !U.isVisible( CompGeom::Vec3 { 5,5, 0 } ) );	// In the plane
+
+  // Off the origin the offset places the plane
+  CompGeom::Points<3> Q ( CompGeom::Geometry { {0,0,2}, {1,0,2}, {0,1,2} } );
+  CompGeom::Triangle V ( 0,1,2,Q );
+  WVPASSNEAR ( V.offset(), -2 );
+  WVPASS (  V.isVisible( CompGeom::Vec3 { 0,0,2.5 } ) );
+  WVPASS ( !V.isVisible( CompGeom::Vec3 { 9,9,1.5 } ) );
 }
 
 WVTEST_MAIN("Edge Struct") {
@@ -169,6 +239,11 @@ WVTEST_MAIN("Compare 2D algorithms") {
 
   WVPASS ( result1 == result2 );
   WVPASS ( result1 == result3 );
+
+  // The Geometry versions only copy the points into arrays
+  CompGeom::Points<2> points ( geom );
+  WVPASS ( giftWrap   ( geom ) == giftWrap   ( points ) );
+  WVPASS ( grahamScan ( geom ) == grahamScan ( points ) );
 }
 
 
@@ -189,14 +264,106 @@ WVTEST_MAIN("3D Insertion Method") {
   WVPASS ( result == std::vector<size_t> ( { 1,2,3,4,5,6 } ) );
 }
 
+WVTEST_MAIN("Hull mesh") {
+  CompGeom::Geometry geom (3);
+  geom.addRandom ( 5000 );
+  CompGeom::HullMesh mesh;
+  const auto tris = insertion3D ( geom, mesh );
+  WVPASS ( tris == insertion3D ( geom ) );
+  WVPASSEQ ( mesh.size(), tris.size() );
+
+  // Every edge is joined to one running the other way on another triangle
+  bool joined = true;
+  for ( uint32_t e=0; e<3*mesh.size(); e++ ) {
+    const uint32_t t = mesh.twin ( e );
+    joined &= t != NOEDGE && mesh.twin ( t ) == e && CompGeom::HullMesh::face ( t ) != CompGeom::HullMesh::face ( e );
+    joined &= mesh.origin ( t ) == mesh.target ( e ) && mesh.target ( t ) == mesh.origin ( e );
+  }
+  WVPASS ( joined );
+  WVPASS ( mesh[0][0] == tris[0][0] && mesh.neighbour ( 0, 0 ) < mesh.size() );
+
+  // Removing a triangle leaves its slot empty until the next one is added
+  CompGeom::HullMesh tet;
+  tet.add ( 0, 1, 2 ); tet.add ( 0, 2, 3 ); tet.add ( 2, 1, 3 ); tet.add ( 1, 0, 3 );
+  tet.link ( 0, 9 ); tet.link ( 1, 6 ); tet.link ( 2, 3 );
+  tet.link ( 4, 8 ); tet.link ( 5, 10 ); tet.link ( 7, 11 );
+  tet.remove ( 1 );
+  WVPASSEQ ( tet.size(), 4 );
+  WVPASSEQ ( tet.count(), 3 );
+  WVPASS ( !tet.alive ( 1 ) && tet[2][0] == 2 && tet.twin ( 1 ) == 6 );
+  WVPASSEQ ( tet.triangles().size(), 3 );
+
+  // Compacting moves the rest down and drops edges joined to the gap
+  const auto to = tet.compact();
+  WVPASSEQ ( tet.size(), 3 );
+  WVPASS ( to[1] == NOEDGE && to[2] == 1 && to[3] == 2 );
+  WVPASS ( tet[1][0] == 2 && tet[2][0] == 1 );
+  WVPASS ( tet.twin ( 0 ) == 6 && tet.twin ( 1 ) == 3 && tet.twin ( 5 ) == NOEDGE );
+
+  tet.remove ( 0 );
+  WVPASSEQ ( tet.add ( 0, 1, 2 ), 0 );
+  WVPASS ( tet.alive ( 0 ) && tet.twin ( 0 ) == NOEDGE && tet.count() == 3 );
+}
+
+WVTEST_MAIN("Face pool") {
+  CompGeom::Geometry geom (3);
+  geom.addRandom ( 3000 );
+  const CompGeom::Points<3> pts ( geom );
+
+  // A pool used for one hull after another gives the same hulls
+  CompGeom::FacePool pool;
+  const auto tris = insertion3D ( pts, pool );
+  WVPASS ( tris == insertion3D ( geom ) );
+  WVPASSEQ ( pool.size(), tris.size() );
+  WVPASS ( insertion3D ( pts, pool ) == tris );
+  WVPASSEQ ( pool.mesh().count(), tris.size() );
+
+  // Planes follow the faces, an empty slot is behind every point
+  CompGeom::FacePool small;
+  small.add ( 0, 1, 2, pts );
+  small.add ( 0, 2, 3, pts );
+  small.remove ( 0 );
+  const CompGeom::Vec3 far { 1e30f, -1e30f, 1e30f };
+  WVPASS ( small.sides ( far )[0] < -1e30f );
+  WVPASS ( small.d()[1] == CompGeom::Triangle ( 0, 2, 3, pts ).plane()[3] );
+  WVPASSEQ ( small.add ( 1, 2, 3, pts ), 0 );
+  small.remove ( 1 );
+  small.compact();
+  WVPASSEQ ( small.size(), 1 );
+  WVPASS ( small.d()[0] == CompGeom::Triangle ( 1, 2, 3, pts ).plane()[3] );
+}
+
+WVTEST_MAIN("Hull trace") {
+  CompGeom::Geometry geom { {0,0,0}, {1,0,0}, {0,1,0}, {0,0,1} };
+  std::vector < std::vector < size_t > > tris = { {0,2,1}, {0,1,3}, {0,3,2}, {1,2,3} };
+  {
+    CompGeom::ConvexHull3D trace ( geom, "trace.txt" );
+    trace.update ( tris.begin(), tris.begin()+1 );
+    trace.update ( tris.begin(), tris.end() );
+  }
+
+  // The number of timesteps is filled in at the end
+  std::ifstream file ( "trace.txt" );
+  std::string line, steps;
+  int triangles = 0;
+  while ( std::getline ( file, line ) ) {
+    if ( line.find ( "Number of Timesteps" ) == 0 ) steps = line;
+    if ( line.find ( "Number of Triangles" ) == 0 ) triangles += std::stoi ( line.substr ( 20 ) );
+  }
+  WVPASSEQ ( std::stoi ( steps.substr ( 20 ) ), 2 );
+  WVPASSEQ ( triangles, 5 );
+
+  // A trace without a file does nothing
+  CompGeom::ConvexHull3D none ( geom, "" );
+  none.update ( tris.begin(), tris.end() );
+}
+
 WVTEST_MAIN("gHull Serial") {
   CompGeom::Geometry geom { {0,0,0}, {0,-1,0}, {1,0,0}, {0,0,1}, {-1,0,0},
                             {0,1,0}, {0,0,-1} };
   auto tris = gHullSerial ( geom );  
-  cout << 1 << endl;
   std::vector<size_t> result;
   for ( auto&& t : tris ) {
-    cout << t[0] << endl;
     result.push_back(t[0]);
     result.push_back(t[1]);
     result.push_back(t[2]);
@@ -204,22 +371,740 @@ WVTEST_MAIN("gHull Serial") {
   std::sort(result.begin(),result.end());
   auto it = std::unique(result.begin(),result.end());
   result.resize(std::distance(result.begin(),it));
-  // WVPASS ( result == std::vector<size_t> ( { 1,2,3,4,5,6 } ) );
+  WVPASSEQ ( tris.size(), 8 );
+  WVPASS ( result == std::vector<size_t> ( { 1,2,3,4,5,6 } ) );
+}
+
+// Rotates each triangle to start at its lowest id then sorts them
+static std::vector < std::vector < size_t > > sortedTriangles ( std::vector < std::vector < size_t > > tris ) {
+  for ( auto &t : tris ) std::rotate ( t.begin(), std::min_element ( t.begin(), t.end() ), t.end() );
+  std::sort ( tris.begin(), tris.end() );
+  return tris;
+}
+
+// Each edge of the triangles is used once either way round and no point is
+// in front of any of them
+template < typename Pts >
+static bool isClosedHull ( const std::vector < std::vector < size_t > > &tris, const Pts &pts ) {
+  std::set < std::pair < size_t, size_t > > edges;
+  for ( const auto &t : tris )
+    for ( size_t i=0; i<3; i++ )
+      if ( !edges.insert ( { t[i], t[(i+1)%3] } ).second ) return false;
+  for ( const auto &e : edges )
+    if ( !edges.count ( { e.second, e.first } ) ) return false;
+
+  for ( const auto &t : tris )
+    for ( size_t i=0; i<pts.size(); i++ )
+      if ( CompGeom::orient3DExact ( pts[t[0]], pts[t[1]], pts[t[2]], pts[i] ) > 0 ) return false;
+  return !tris.empty();
+}
+
+WVTEST_MAIN("gHull Serial against 3D Insertion") {
+  for ( int sz : { 50, 2000, 30000 } ) {
+    CompGeom::Geometry geom (3);
+    geom.addRandom ( sz );
+    GHullTimings t;
+    CompGeom::HullWorkspace ws;
+    auto tris = gHullSerial ( geom, ws, EDT_CPU, 128, &t );
+    WVPASS ( sortedTriangles ( tris ) == sortedTriangles ( insertion3D ( geom ) ) );
+    WVPASS ( tris == gHullSerial ( CompGeom::Points<3> ( geom ), ws, EDT_CPU, 128 ) );
+    WVPASS ( t.splaying >= 0 );
+  }
+
+  // Either face of each pair is enough
+  CompGeom::Geometry geom (3);
+  geom.addRandom ( 2000 );
+  CompGeom::HullWorkspace max ( 128, EDT_CPU, { Direction::RIGHT, Direction::FRONT, Direction::UP } );
+  CompGeom::HullWorkspace mixed ( 128, EDT_CPU, { Direction::LEFT, Direction::FRONT, Direction::UP } );
+  const auto tris = sortedTriangles ( insertion3D ( geom ) );
+  WVPASS ( sortedTriangles ( gHullSerial ( geom, max  , EDT_CPU, 128 ) ) == tris );
+  WVPASS ( sortedTriangles ( gHullSerial ( geom, mixed, EDT_CPU, 128 ) ) == tris );
+}
+
+WVTEST_MAIN("Randomized 3D hull") {
+  for ( int sz : { 4, 50, 2000, 30000 } ) {
+    CompGeom::Geometry geom (3);
+    geom.addRandom ( sz );
+    const auto tris = randomizedHull3D ( geom );
+    WVPASS ( sortedTriangles ( tris ) == sortedTriangles ( insertion3D ( geom ) ) );
+    WVPASS ( tris == randomizedHull3D ( CompGeom::Points<3> ( geom ) ) );
+    WVPASS ( sortedTriangles ( tris ) == sortedTriangles ( randomizedHull3D ( geom, 7 ) ) );
+  }
+
+  // Repeated points at the start and points on the hull, which stay on it
+  // if they were added before the corners around them
+  CompGeom::Geometry cube { {0,0,0}, {0,0,0}, {0.5f,0,0}, {1,0,0}, {0,1,0}, {1,1,0}, {0,0,1},
+                            {1,0,1}, {0,1,1}, {1,1,1}, {0.5f,0.5f,0.5f}, {1,1,1} };
+  for ( unsigned seed : { 1u, 2u, 3u, 4u, 5u } ) {
+    const auto tris = randomizedHull3D ( cube, seed );
+    const CompGeom::Points<3> pts ( cube );
+    bool convex = true;
+    std::vector < size_t > corners;
+    for ( const auto &t : tris ) {
+      for ( size_t i=0; i<pts.size(); i++ )
+	convex &= CompGeom::orient3DExact ( pts[t[0]], pts[t[1]], pts[t[2]], pts[i] ) <= 0;
+      for ( size_t v : t ) if ( v != 2 ) corners.push_back ( v );
+    }
+    std::sort ( corners.begin(), corners.end() );
+    corners.erase ( std::unique ( corners.begin(), corners.end() ), corners.end() );
+    WVPASS ( convex );
+    WVPASSEQ ( corners.size(), 8 );
+  }
+
+  CompGeom::Geometry flat { {0,0,0}, {1,0,0}, {0,1,0}, {1,1,0}, {2,3,0} };
+  bool threw = false;
+  try { randomizedHull3D ( flat ); } catch ( std::logic_error & ) { threw = true; }
+  WVPASS ( threw );
+}
+
+WVTEST_MAIN("QuickHull 3D") {
+  for ( int sz : { 4, 50, 2000, 30000 } ) {
+    CompGeom::Geometry geom (3);
+    geom.addRandom ( sz );
+    const auto tris = quickHull3D ( geom );
+    WVPASS ( sortedTriangles ( tris ) == sortedTriangles ( insertion3D ( geom ) ) );
+    WVPASS ( tris == quickHull3D ( CompGeom::Points<3> ( geom ) ) );
+
+    // The same whatever the number of threads
+    CompGeom::setNumThreads ( 1 );
+    WVPASS ( tris == quickHull3D ( geom ) );
+    CompGeom::setNumThreads ( 3 );
+    WVPASS ( tris == quickHull3D ( geom ) );
+    CompGeom::setNumThreads ( 0 );
+  }
+
+  // A grid has many points on each face and the first extremes are repeated
+  CompGeom::Geometry grid (3);
+  for ( int i=0; i<6; i++ )
+    for ( int j=0; j<6; j++ )
+      for ( int k=0; k<6; k++ ) grid.addPoint ( { float(i), float(j), float(k) } );
+  const CompGeom::Points<3> pts ( grid );
+  bool convex = true;
+  std::vector < size_t > corners;
+  for ( const auto &t : quickHull3D ( grid ) ) {
+    for ( size_t i=0; i<pts.size(); i++ )
+      convex &= CompGeom::orient3DExact ( pts[t[0]], pts[t[1]], pts[t[2]], pts[i] ) <= 0;
+    corners.insert ( corners.end(), t.begin(), t.end() );
+  }
+  std::sort ( corners.begin(), corners.end() );
+  corners.erase ( std::unique ( corners.begin(), corners.end() ), corners.end() );
+  WVPASS ( convex );
+  WVPASSEQ ( corners.size(), 8 );
+
+  CompGeom::Geometry flat { {0,0,0}, {1,0,0}, {0,1,0}, {1,1,0}, {2,3,0} };
+  bool threw = false;
+  try { quickHull3D ( flat ); } catch ( std::logic_error & ) { threw = true; }
+  WVPASS ( threw );
 }
 
+WVTEST_MAIN("Parallel 3D hull") {
+  for ( int sz : { 4, 50, 2000, 30000 } ) {
+    CompGeom::Geometry geom (3);
+    geom.addRandom ( sz );
+    const auto tris = parallelHull3D ( geom );
+    WVPASS ( sortedTriangles ( tris ) == sortedTriangles ( insertion3D ( geom ) ) );
+    WVPASS ( sortedTriangles ( tris ) == sortedTriangles ( randomizedHull3D ( geom ) ) );
+    WVPASS ( tris == parallelHull3D ( CompGeom::Points<3> ( geom ) ) );
+    WVPASS ( sortedTriangles ( parallelHull3D ( geom, 7 ) ) == sortedTriangles ( tris ) );
 
-CompGeom::Star constructStar_h ( const CompGeom::WorkingSet & W, const CompGeom::Geometry &geom );
+    // The same whatever the number of threads
+    CompGeom::setNumThreads ( 1 );
+    WVPASS ( tris == parallelHull3D ( geom ) );
+    CompGeom::setNumThreads ( 3 );
+    WVPASS ( tris == parallelHull3D ( geom ) );
+    CompGeom::setNumThreads ( 0 );
+  }
+
+  // Points on the flat faces of a grid may be kept as vertices if they come
+  // before the corners around them, like randomizedHull3D
+  CompGeom::Geometry grid (3);
+  for ( int i=0; i<6; i++ )
+    for ( int j=0; j<6; j++ )
+      for ( int k=0; k<6; k++ ) grid.addPoint ( { float(i), float(j), float(k) } );
+  const CompGeom::Points<3> pts ( grid );
+  bool convex = true;
+  std::vector < size_t > corners;
+  bool boundary = true;
+  for ( const auto &t : parallelHull3D ( grid ) ) {
+    for ( size_t i=0; i<pts.size(); i++ )
+      convex &= CompGeom::orient3DExact ( pts[t[0]], pts[t[1]], pts[t[2]], pts[i] ) <= 0;
+    for ( size_t v : t ) {
+      const CompGeom::Vec3 p = pts[v];
+      boundary &= p.x == 0 || p.x == 5 || p.y == 0 || p.y == 5 || p.z == 0 || p.z == 5;
+      if ( ( p.x == 0 || p.x == 5 ) && ( p.y == 0 || p.y == 5 ) && ( p.z == 0 || p.z == 5 ) )
+	corners.push_back ( v );
+    }
+  }
+  std::sort ( corners.begin(), corners.end() );
+  corners.erase ( std::unique ( corners.begin(), corners.end() ), corners.end() );
+  WVPASS ( convex );
+  WVPASS ( boundary );
+  WVPASSEQ ( corners.size(), 8 );
+
+  CompGeom::Geometry flat { {0,0,0}, {1,0,0}, {0,1,0}, {1,1,0}, {2,3,0} };
+  bool threw = false;
+  try { parallelHull3D ( flat ); } catch ( std::logic_error & ) { threw = true; }
+  WVPASS ( threw );
+}
+
+WVTEST_MAIN("gHull Serial on different numbers of threads") {
+  CompGeom::Geometry geom (3);
+  geom.addRandom ( 20000 );
+  CompGeom::HullWorkspace ws;
+
+  CompGeom::setNumThreads ( 1 );
+  auto serial = gHullSerial ( geom, ws, EDT_CPU, 256 );
+  CompGeom::setNumThreads ( 5 );
+  auto threaded = gHullSerial ( geom, ws, EDT_CPU, 256 );
+  CompGeom::setNumThreads ( 0 );
+  WVPASS ( serial == threaded );
+}
+
+// Checks every pixel of a Voronoi texture is coloured by one of its nearest sites
+static bool isNearestSiteMap ( const std::vector < short > &output, int S, 
+			       const std::vector < std::vector < int > > &sites ) 
+{
+  bool nearest = true;
+  for ( int y=0; y<S; y++ ) {
+    for ( int x=0; x<S; x++ ) {
+      int best = std::numeric_limits<int>::max();
+      for ( auto s : sites ) 
+	best = std::min ( best, (s[0]-x)*(s[0]-x) + (s[1]-y)*(s[1]-y) );
+      int sx = output[2*(y*S+x)], sy = output[2*(y*S+x)+1];
+      nearest = nearest && (sx-x)*(sx-x) + (sy-y)*(sy-y) == best;
+    }
+  }
+  return nearest;
+}
+
+static std::vector < short > voronoiInput ( int S, const std::vector < std::vector < int > > &sites ) {
+  std::vector < short > input ( 2*S*S, MARKER );
+  for ( auto s : sites ) {
+    input[2*(s[1]*S + s[0])  ] = s[0];
+    input[2*(s[1]*S + s[0])+1] = s[1];
+  }
+  return input;
+}
+
+WVTEST_MAIN("PBA on the cpu") {
+  const int S = 64;
+  std::vector < std::vector < int > > sites = { {3,5}, {60,2}, {31,31}, {10,50}, {63,63}, {40,20} };
+  std::vector < short > input = voronoiInput ( S, sites ), output ( 2*S*S );
+
+  CompGeom::PBA2DCpu pba ( S );
+  pba.voronoiDiagram ( &input[0], &output[0], 4, 8, 2 );
+  WVPASS ( isNearestSiteMap ( output, S, sites ) );
+
+  auto tris = gHullSerial ( CompGeom::Geometry { {0,0,0}, {0,-1,0}, {1,0,0}, {0,0,1}, 
+						 {-1,0,0}, {0,1,0}, {0,0,-1} }, PBA_CPU );
+  WVPASS ( !tris.empty() );
+}
+
+WVTEST_MAIN("Distance transform Voronoi") {
+  const int S = 60;		// Not a multiple of the vector width
+  std::vector < std::vector < int > > sites = { {3,5}, {59,2}, {31,31}, {10,50}, {59,59}, {40,20}, {41,20} };
+  std::vector < short > input = voronoiInput ( S, sites ), output ( 2*S*S );
+
+  CompGeom::EDT2DCpu edt ( S );
+  edt.voronoiDiagram ( &input[0], &output[0] );
+  WVPASS ( isNearestSiteMap ( output, S, sites ) );
+}
+
+WVTEST_MAIN("Voronoi image") {
+  Voronoi V ( 4 );
+  V.set ( 1, 2, 5, 7 );
+  WVPASSEQ ( V.length(), 4 );
+  WVPASSEQ ( V(1,2).x, 5 );
+  WVPASSEQ ( V(1,2).y, 7 );
+  WVPASSEQ ( V.data()[2*(1*4+2)+1], 7 );	// Same layout as the pba textures
+  WVPASS   ( V(1,2) != V(2,1) );
+}
+
+WVTEST_MAIN("Projection resolution") {
+  typedef std::vector < float   > FloatExtremes;
+  typedef std::vector < int32_t > IntExtremes;
+  WVPASSEQ ( adaptiveResolution ( 10     , FloatExtremes { 0,0,0,1,1,1 } ), 64   );
+  WVPASSEQ ( adaptiveResolution ( 1000000, FloatExtremes { 0,0,0,1,1,1 } ), 1024 );
+  WVPASSEQ ( adaptiveResolution ( 1000000, FloatExtremes { 0,0,0,4,1,1 } ), 2048 );
+  WVPASSEQ ( adaptiveResolution ( 1000000, FloatExtremes { 0,0,0,1,1,0 } ), 1024 );
+  WVPASSEQ ( adaptiveResolution ( 1000000, IntExtremes   { 0,0,0,4,1,1 } ), 2048 );
+  WVPASSEQ ( adaptiveResolution ( 1000000, IntExtremes   { -2000000000,0,0,2000000000,1000000000,1000000000 } ), 2048 );
+
+  CompGeom::Geometry geom { {0,0,0}, {0,-1,0}, {1,0,0}, {0,0,1}, {-1,0,0},
+                            {0,1,0}, {0,0,-1} };
+  WVPASS ( !gHullSerial ( geom, EDT_CPU, 100 ).empty() );
+  WVPASS ( !gHullSerial ( geom, PBA_CPU, ADAPTIVE_RESOLUTION ).empty() );
+
+  // 100 isn't divisible by the pba band sizes
+  bool thrown = false;
+  try { gHullSerial ( geom, PBA_CPU, 100 ); }
+  catch ( std::logic_error & ) { thrown = true; }
+  WVPASS ( thrown );
+}
+
+WVTEST_MAIN("Projection to the box") {
+  CompGeom::Geometry geom (3);
+  geom.addRandom ( 20000 );
+  geom.addPoint  ( { 10,0,0 } );
+  geom.addPoint  ( { 10,0,0 } );	// Same distance, the lower id must win
+  auto ex = findExtremes2 ( geom );
+
+  CompGeom::setNumThreads ( 1 );
+  CompGeom::HullWorkspace W1 ( 64, EDT_CPU );
+  projectToBox ( W1, geom, ex );
+  CompGeom::setNumThreads ( 3 );
+  CompGeom::HullWorkspace W3 ( 64, EDT_CPU );
+  projectToBox ( W3, geom, ex );
+  CompGeom::setNumThreads ( 0 );
+
+  const CompGeom::BoundingBox &B1 = W1.box(), &B3 = W3.box();
+  bool same = true, found = false, lost = false;
+  for ( auto dir : Direction::allDirections() ) {
+    for ( size_t i=0; i<64; i++ ) {
+      for ( size_t j=0; j<64; j++ ) {
+	same  = same  && B1[dir].getID(i,j) == B3[dir].getID(i,j);
+	found = found || B1[dir].getID(i,j) == 20000;
+	lost  = lost  || B1[dir].getID(i,j) == 20001;
+      }
+    }
+  }
+  WVPASS ( same  );
+  WVPASS ( found );
+  WVFAIL ( lost  );
+
+  // Only the faces asked for are allocated and projected onto
+  CompGeom::HullWorkspace WL ( 64, EDT_CPU, { Direction::LEFT } );
+  projectToBox ( WL, geom, ex );
+  const CompGeom::BoundingBox &BL = WL.box();
+  WVPASS   ( BL.hasFace ( Direction::LEFT  ) );
+  WVFAIL   ( BL.hasFace ( Direction::RIGHT ) );
+  WVPASSEQ ( BL[Direction::RIGHT].length(), 0 );
+  WVPASSEQ ( BL[Direction::LEFT].getID(31,31), B1[Direction::LEFT].getID(31,31) );
+
+  // A pixel keeps the closest point, the lowest id on a tie
+  CompGeom::Tile T ( 2 );
+  WVPASS   ( T.keepMin ( 1, CompGeom::Tile::pack ( 2.5f, 9 ) ) );
+  WVFAIL   ( T.keepMin ( 1, CompGeom::Tile::pack ( 2.5f, 7 ) ) );
+  WVFAIL   ( T.keepMin ( 1, CompGeom::Tile::pack ( 3.0f, 1 ) ) );
+  WVPASSEQ ( T.getID ( 0, 1 ), 7 );
+  WVPASS   ( T.get   ( 0, 1 ) == 2.5f );
+  WVPASSEQ ( T.getID ( 0, 0 ), CompGeom::Tile::noID() );
+}
+
+WVTEST_MAIN("Reusing a workspace") {
+  CompGeom::Geometry big (3), small (3);
+  big  .addRandom ( 5000 );
+  small.addPoint  ( { 0,0,0 } );
+  small.addPoint  ( { 1,0,0 } );
+  small.addPoint  ( { 0,1,0 } );
+  small.addPoint  ( { 0,0,1 } );
+
+  // Nothing of the big geometry may be left after a reset
+  CompGeom::HullWorkspace ws ( 64, EDT_CPU ), fresh ( 64, EDT_CPU );
+  projectToBox ( ws, big, findExtremes2 ( big ) );
+  ws.prepare   ( 64, EDT_CPU );
+  projectToBox ( ws   , small, findExtremes2 ( small ) );
+  projectToBox ( fresh, small, findExtremes2 ( small ) );
+  constructVoronois ( ws    );
+  constructVoronois ( fresh );
+
+  bool same = true;
+  for ( auto dir : Direction::allDirections() ) {
+    for ( size_t i=0; i<64; i++ ) {
+      for ( size_t j=0; j<64; j++ ) {
+	same = same && ws.box()[dir].getID(i,j) == fresh.box()[dir].getID(i,j);
+	same = same && ws.voronois()[dir](i,j) == fresh.voronois()[dir](i,j);
+      }
+    }
+  }
+  WVPASS ( same );
+
+  // Changing the resolution reallocates
+  WVPASS   ( !gHullSerial ( small, ws, EDT_CPU, 32 ).empty() );
+  WVPASSEQ ( ws.box().length(), 32 );
+}
+
+WVTEST_MAIN("Radix sort") {
+  std::vector < uint64_t > keys, scratch, sorted;
+  std::vector < size_t   > counts;
+  std::default_random_engine gen ( 12 );
+  for ( int i=0; i<100000; i++ ) keys.push_back ( gen() % 5000 + (uint64_t(gen() % 3) << 20) );
+  sorted = keys;
+  std::sort ( sorted.begin(), sorted.end() );
+  sorted.erase ( std::unique ( sorted.begin(), sorted.end() ), sorted.end() );
+
+  CompGeom::setNumThreads ( 3 );
+  CompGeom::radixSort    ( keys, scratch, counts, 22 );
+  WVPASS ( std::is_sorted ( keys.begin(), keys.end() ) );
+  CompGeom::uniqueSorted ( keys, scratch, counts );
+  CompGeom::setNumThreads ( 0 );
+  WVPASS ( keys == sorted );
+}
+
+WVTEST_MAIN("Thread pool") {
+  CompGeom::ThreadPool pool ( 4 );
+  WVPASSEQ ( pool.size(), 4 );
+
+  // Every task runs once, on a worker of the pool
+  std::vector < int > runs ( 1000, 0 );
+  std::vector < size_t > workers ( 1000 );
+  pool.run ( runs.size(), [&] ( size_t t, size_t w ) { runs[t]++; workers[t] = w; } );
+  WVPASS ( std::count ( runs.begin(), runs.end(), 1 ) == 1000 );
+  WVPASS ( *std::max_element ( workers.begin(), workers.end() ) < 4 );
+
+  bool thrown = false;
+  try { pool.run ( 10, [] ( size_t t, size_t ) { if ( t == 7 ) throw std::runtime_error ( "task" ); } ); }
+  catch ( std::runtime_error &e ) { thrown = true; }
+  WVPASS ( thrown );
+  WVPASS ( !CompGeom::ThreadPool::working() );
+
+  // A task that runs another pool is still working once it returns
+  CompGeom::ThreadPool inner ( 2 );
+  std::vector < char > stillWorking ( 10, 0 );
+  pool.run ( 10, [&] ( size_t t, size_t ) {
+      if ( t == 0 ) inner.run ( 4, [] ( size_t, size_t ) {} );
+      stillWorking[t] = CompGeom::ThreadPool::working();
+    } );
+  WVPASS ( std::count ( stillWorking.begin(), stillWorking.end(), 1 ) == 10 );
+  WVPASS ( !CompGeom::ThreadPool::working() );
+
+  // The pool is still usable after an exception
+  runs.assign ( 10, 0 );
+  pool.run ( 10, [&] ( size_t t, size_t ) { runs[t]++; } );
+  WVPASS ( std::count ( runs.begin(), runs.end(), 1 ) == 10 );
+
+  // A shared pool still held stays usable when the number of threads changes
+  CompGeom::setNumThreads ( 2 );
+  const auto held = CompGeom::threadPool();
+  CompGeom::setNumThreads ( 3 );
+  WVPASSEQ ( CompGeom::threadPool()->size(), 3 );
+  runs.assign ( 10, 0 );
+  held->run ( 10, [&] ( size_t t, size_t ) { runs[t]++; } );
+  WVPASSEQ ( held->size(), 2 );
+  WVPASS   ( std::count ( runs.begin(), runs.end(), 1 ) == 10 );
+
+  // parallelFor runs on the shared pool, calls from inside a task run serially
+  runs.assign ( 1000, 0 );
+  CompGeom::parallelFor ( 10, [&] ( size_t i ) {
+      CompGeom::parallelFor ( 100, [&] ( size_t j ) { runs[100*i+j]++; } );
+    } );
+  WVPASS ( std::count ( runs.begin(), runs.end(), 1 ) == 1000 );
+  runs.assign ( 5, 0 );
+  CompGeom::parallelFor ( 5, [&] ( size_t i ) { runs[i]++; }, 100 );
+  WVPASS ( std::count ( runs.begin(), runs.end(), 1 ) == 5 );
+
+  thrown = false;
+  try { CompGeom::parallelFor ( 10, [] ( size_t i ) { if ( i == 7 ) throw std::runtime_error ( "i" ); } ); }
+  catch ( std::runtime_error &e ) { thrown = true; }
+  WVPASS ( thrown );
+  CompGeom::setNumThreads ( 0 );
+}
+
+WVTEST_MAIN("Working sets") {
+  CompGeom::WorkingSets W;
+  W.ids        = { 3, 7 };
+  W.offsets    = { 0, 2, 5 };
+  W.neighbours = { 1, 4, 0, 2, 9 };
+
+  WVPASSEQ ( W.size(), 2 );
+  WVPASSEQ ( W[0].id, 3 );
+  WVPASSEQ ( W[0].size(), 2 );
+  WVPASSEQ ( W[1].id, 7 );
+  WVPASS   ( std::vector < uint32_t > ( W[1].begin(), W[1].end() ) == std::vector < uint32_t > ({0,2,9}) );
+
+  W.clear();
+  WVPASS ( W.empty() );
+}
+
+WVTEST_MAIN("Star ring buffer") {
+  typedef std::vector < uint32_t > ids;
+  CompGeom::StarArena arena;
+  CompGeom::Star s = arena.add ( 5 );
+  s.assign ( { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 } );
+  WVPASSEQ ( s.id(), 5 );
+
+  s.erase ( 1, 2 );			// Near the front
+  WVPASS ( ids ( s.begin(), s.end() ) == ids ({ 0, 3, 4, 5, 6, 7, 8, 9 }) );
+  s.erase ( 6, 4 );			// Wraps round to the front
+  WVPASS ( ids ( s.begin(), s.end() ) == ids ({ 4, 5, 6, 7 }) );
+  s.insert ( 0, 100 );
+  s.insert ( s.size(), 101 );
+  s.insert ( 3, 102 );
+  WVPASS ( ids ( s.begin(), s.end() ) == ids ({ 100, 4, 5, 102, 6, 7, 101 }) );
+
+  // Outgrowing the arena moves the star to its own ring
+  CompGeom::Star t = arena.add ( 6 );
+  ids expected;
+  for ( uint32_t i=0; i<40; i++ ) {
+    t.insert ( i/3, i );
+    expected.insert ( expected.begin() + i/3, i );
+  }
+  WVPASSEQ ( arena.nSpilled(), 1 );
+  WVPASS ( ids ( t.begin(), t.end() ) == expected );
+  WVPASS ( ids ( s.begin(), s.end() ) == ids ({ 100, 4, 5, 102, 6, 7, 101 }) );
+}
+
+CompGeom::Star constructStar_h ( const CompGeom::WorkingSetSpan & W, const CompGeom::Points<3> &pts,
+				 CompGeom::StarArena &arena );
 
 WVTEST_MAIN("Constructing Stars") {
   CompGeom::Geometry geom =  { {0,0,0}, {0,-1,0}, {1,0,0}, {0,0,1}, {-1,0,0},
 			       {0,1,0}, {0,0,-1}, {0,0,0}, {2,0,0}, {0,0,2}, {-2,0,0},
 			       {0,2,0}, {0,0,-2}, {-2,0,2}, {0,0,3} };
-  CompGeom::WorkingSet W = { { 1,0}, {1,2}, {1,3}, {1,4}, {1,5}, {1,6}, {1,7},{1,8},{1,9},{1,10},{1,11},{1,12},{1,13},{1,14} };
-  CompGeom::Star S = constructStar_h ( W, geom );
+  std::vector < uint32_t > N = { 0, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14 };
+  const CompGeom::Points<3> pts ( geom );
+  CompGeom::StarArena arena;
+  CompGeom::Star S = constructStar_h ( CompGeom::WorkingSetSpan { 1, &N[0], &N[0] + N.size() }, pts, arena );
   
-  cout << S.id << endl;
+  cout << S.id() << endl;
   for ( auto s : S ) cout << s << " ";
   cout << endl;
 
   WVPASS ( std::vector < size_t > ( S.begin(), S.end() ) == std::vector< size_t > ({8,14,13,10,12}) );
 }
+
+WVTEST_MAIN("Batch predicates") {
+  // Signs on points whose answer is known
+  const float x[3] = { 0, 1, 2 }, y[3] = { 1, -1, 0 }, z[3] = { 3, -2, 0 };
+  float out[3];
+  CompGeom::orient2D ( 0,0, 1,0, x, y, 3, out );
+  WVPASS ( out[0] > 0 && out[1] < 0 && out[2] == 0 );
+  const float plane[4] = { 0, 0, 1, -1 };	// z = 1, facing up
+  CompGeom::planeSide ( plane, x, y, z, 3, out );
+  WVPASS ( out[0] > 0 && out[1] < 0 && out[2] < 0 );
+
+  // Every instruction set gives the same bits, sizes that aren't whole vectors
+  // leave points for the scalar code
+  std::default_random_engine            gen ( 2381 );
+  std::uniform_real_distribution<float> dist ( -10, 10 );
+  const size_t n = 1000 + 13;
+  std::vector < float > px(n), py(n), pz(n), pd(n);
+  for ( size_t i=0; i<n; i++ ) { px[i] = dist(gen); py[i] = dist(gen); pz[i] = dist(gen); pd[i] = dist(gen); }
+  const float pl[4] = { dist(gen), dist(gen), dist(gen), dist(gen) };
+
+  std::vector < std::vector < float > > results;
+  std::vector < size_t > furthest;
+  const CompGeom::SimdLevel start = CompGeom::simdLevel();
+  for ( auto level : { CompGeom::SIMD_SCALAR, CompGeom::SIMD_AVX2, CompGeom::SIMD_AVX512 } ) {
+    WVPASS ( CompGeom::setSimdLevel ( level ) <= level );
+    std::vector < float > o ( 3*n );
+    CompGeom::orient2D   ( px[0], py[0], px[1], py[1], px.data(), py.data(), n, &o[0] );
+    CompGeom::planeSide  ( pl, px.data(), py.data(), pz.data(), n, &o[n] );
+    CompGeom::planesSide ( px.data(), py.data(), pz.data(), pd.data(), n, pl[0], pl[1], pl[2], &o[2*n] );
+    results.push_back ( o );
+
+    float left;
+    furthest.push_back ( CompGeom::maxOrient2D ( px[0], py[0], px[1], py[1], px.data(), py.data(), n, left ) );
+    furthest.push_back ( left == o[furthest.back()] );
+    furthest.push_back ( CompGeom::maxOrient2D ( 0, 0, 1, 0, px.data(), py.data(), 5, left ) );
+  }
+  CompGeom::setSimdLevel ( start );
+  WVPASS ( results[0] == results[1] );
+  WVPASS ( results[0] == results[2] );
+  WVPASS ( furthest[0] == size_t ( std::max_element ( results[0].begin(), results[0].begin()+n ) - results[0].begin() ) );
+  WVPASS ( furthest[1] );
+  WVPASS ( std::equal ( furthest.begin(), furthest.begin()+3, furthest.begin()+3 ) );
+  WVPASS ( std::equal ( furthest.begin(), furthest.begin()+3, furthest.begin()+6 ) );
+
+  // Equal values give the first of them
+  const float sx[20] = { 0 }, sy[20] = { 0 };
+  float left;
+  WVPASS ( CompGeom::maxOrient2D ( 0, 0, 1, 0, sx, sy, 20, left ) == 0 );
+  WVPASS ( left == 0 );
+
+  // Near rather than equal, this file may be compiled to fuse the sums
+  bool agree = true;
+  for ( size_t i=0; i<n; i++ ) {
+    const float o = (px[1]-px[0])*(py[i]-py[0]) - (py[1]-py[0])*(px[i]-px[0]);
+    const float s = pl[0]*px[i] + pl[1]*py[i] + pl[2]*pz[i] + pl[3];
+    agree &= fabs ( results[0][i]   - o ) < 1e-3;
+    agree &= fabs ( results[0][n+i] - s ) < 1e-3;
+  }
+  WVPASS ( agree );
+  WVPASS ( CompGeom::simdLevel() == CompGeom::cpuSimdLevel() );
+}
+
+WVTEST_MAIN("Exact predicates") {
+  // One ulp either side of a line and of a plane
+  const double up = std::nextafter ( 24.0, 25.0 ), down = std::nextafter ( 24.0, 23.0 );
+  WVPASS ( CompGeom::orient2DExact ( 0.5, 0.5, 12, 12, 24, 24   ) ==  0 );
+  WVPASS ( CompGeom::orient2DExact ( 0.5, 0.5, 12, 12, 24, up   ) ==  1 );
+  WVPASS ( CompGeom::orient2DExact ( 0.5, 0.5, 12, 12, 24, down ) == -1 );
+
+  const float h = 1000.1f, hUp = std::nextafter ( h, 2000.f );
+  const CompGeom::Vec3 a = { 0.1f, 0.3f, h }, b = { 7.7f, 0.2f, h }, c = { 0.6f, 9.1f, h };
+  const CompGeom::Vec3 on = { 3.3f, 3.3f, h }, above = { 3.3f, 3.3f, hUp };
+  WVPASS ( CompGeom::orient3DExact ( a, b, c, on    ) ==  0 );
+  WVPASS ( CompGeom::orient3DExact ( a, b, c, above ) ==  1 );
+  WVPASS ( CompGeom::orient3DExact ( a, c, b, above ) == -1 );
+
+  // Against 64 bit integers on points made coplanar or nearly so
+  std::default_random_engine           gen ( 57 );
+  std::uniform_int_distribution<int>   coord ( -100, 100 ), nudge ( -1, 1 );
+  bool agree = true;
+  for ( int k=0; k<2000; k++ ) {
+    int64_t p[4][3];
+    const int64_t s = coord(gen), t = coord(gen);
+    for ( int j=0; j<3; j++ ) {
+      p[0][j] = coord(gen); p[1][j] = coord(gen); p[2][j] = coord(gen);
+      p[3][j] = 100*p[0][j] + s*(p[1][j]-p[0][j]) + t*(p[2][j]-p[0][j]) + nudge(gen);
+      p[0][j] *= 100; p[1][j] *= 100; p[2][j] *= 100;
+    }
+    const int64_t u[3] = { p[1][0]-p[0][0], p[1][1]-p[0][1], p[1][2]-p[0][2] };
+    const int64_t v[3] = { p[2][0]-p[0][0], p[2][1]-p[0][1], p[2][2]-p[0][2] };
+    const int64_t w[3] = { p[3][0]-p[0][0], p[3][1]-p[0][1], p[3][2]-p[0][2] };
+    const int64_t det = (u[1]*v[2] - u[2]*v[1]) * w[0] + (u[2]*v[0] - u[0]*v[2]) * w[1]
+                      + (u[0]*v[1] - u[1]*v[0]) * w[2];
+    double d[4][3];
+    for ( int i=0; i<4; i++ ) for ( int j=0; j<3; j++ ) d[i][j] = double ( p[i][j] );
+    agree &= CompGeom::orient3DExact ( d[0], d[1], d[2], d[3] ) == ( det > 0 ) - ( det < 0 );
+  }
+  WVPASS ( agree );
+
+  // Points in general position almost never need the exact sums
+  const size_t before = CompGeom::exactFallbacks();
+  std::normal_distribution<float> normal ( 0, 1 );
+  for ( int k=0; k<100000; k++ ) {
+    CompGeom::Vec3 v[4];
+    for ( auto &p : v ) p = { normal(gen), normal(gen), normal(gen) };
+    CompGeom::orient3DExact ( v[0], v[1], v[2], v[3] );
+  }
+  WVPASS ( CompGeom::exactFallbacks() - before < 100 );
+
+  // Perturbed, coplanar points always have a side, which swaps with two points
+  const double q[4][3] = { { 0, 0, 0 }, { 1, 0, 0 }, { 0, 1, 0 }, { 1, 1, 0 } };
+  const double r[4][3] = { { 1, 0, 0 }, { 0, 0, 0 }, { 0, 1, 0 }, { 1, 1, 0 } };
+  size_t id[4] = { 0, 1, 2, 3 };
+  bool sided = true;
+  do {
+    const size_t swapped[4] = { id[1], id[0], id[2], id[3] };
+    const int    s = CompGeom::orient3DPerturbed ( q, id );
+    sided &= s != 0 && CompGeom::orient3DPerturbed ( r, swapped ) == -s;
+  } while ( std::next_permutation ( id, id+4 ) );
+  WVPASS ( CompGeom::orient3DExact ( q[0], q[1], q[2], q[3] ) == 0 && sided );
+  const size_t same[4] = { 0, 1, 1, 3 };
+  WVPASS ( CompGeom::orient3DPerturbed ( q, same ) == 0 );
+}
+
+WVTEST_MAIN("Hulls of degenerate points") {
+  // The first four points are coplanar, then all of them
+  CompGeom::Geometry geom { {0,0,0}, {1,0,0}, {0,1,0}, {1,1,0}, {0.5f,0.5f,1}, {0.5f,0.5f,-1} };
+  auto tris = insertion3D ( geom );
+  WVPASSEQ ( tris.size(), 8 );
+  const CompGeom::Points<3> pts ( geom );
+  bool convex = true;
+  for ( const auto &t : tris )
+    for ( size_t i=0; i<pts.size(); i++ )
+      convex &= CompGeom::orient3DExact ( pts[t[0]], pts[t[1]], pts[t[2]], pts[i] ) <= 0;
+  WVPASS ( convex );
+
+  CompGeom::Geometry flat { {0,0,0}, {1,0,0}, {0,1,0}, {1,1,0}, {2,3,0} };
+  bool threw = false;
+  try { insertion3D ( flat ); } catch ( std::logic_error & ) { threw = true; }
+  WVPASS ( threw );
+
+  // Points a rounding error off a line, no point is left of a gift wrap edge
+  CompGeom::Geometry line { 2 };
+  for ( int i=0; i<1000; i++ ) {
+    const float x = 0.1f * i;
+    line.addPoint ( { x, i % 3 == 0 ? std::nextafter ( 0.3f*x, 1e3f ) : 0.3f*x } );
+  }
+  line.addPoint ( { 50, -1 } );
+  const auto hull = giftWrap ( line );
+  const CompGeom::Points<2> flatLine ( line );
+  bool noneLeft = true;
+  for ( size_t k=0; k+1<hull.size(); k++ )
+    for ( size_t i=0; i<flatLine.size(); i++ )
+      noneLeft &= CompGeom::orient2DExact ( flatLine[hull[k]], flatLine[hull[k+1]], flatLine[i] ) <= 0;
+  WVPASS ( noneLeft );
+
+  // Every point on a small grid, with many on each face and repeats, the
+  // perturbed predicates let star splaying settle
+  std::default_random_engine gen ( 20 );
+  CompGeom::Points<3> grid;
+  for ( int i=0; i<20000; i++ )
+    grid.push_back ( CompGeom::Vec3 { float ( gen() % 21 ), float ( gen() % 21 ), float ( gen() % 21 ) } );
+  CompGeom::HullWorkspace ws;
+  WVPASS ( isClosedHull ( gHullSerial ( grid, ws, EDT_CPU, 128 ), grid ) );
+}
+
+WVTEST_MAIN("Integer points") {
+  // Integral input is kept, anything else is scaled onto the integers
+  CompGeom::Geometry whole { {1,2,3}, {-4,5,6}, {7,-8,9} };
+  const auto kept = CompGeom::quantize<3> ( whole );
+  WVPASS ( kept.exact() );
+  WVPASSEQ ( kept.size(), 3 );
+  WVPASS ( kept[1].x == -4 && kept[1].y == 5 && kept[1].z == 6 );
+
+  CompGeom::Geometry part { {0.5f,2}, {1.25f,-3}, {9,9} };
+  const auto scaled = CompGeom::quantize<2> ( part, 10 );
+  WVPASS ( !scaled.exact() );
+  WVPASS ( scaled[0].x == 0 && scaled[1].y == 0 && scaled[2].y == 1023 );
+  const CompGeom::Geometry back = scaled.geometry();
+  WVPASS ( std::fabs ( back[1][0] - 1.25f ) < 0.01f );
+
+  // Integers too big for a float are read exactly
+  const std::string file = "intPoints.txt";
+  {
+    std::ofstream out ( file );
+    out << "40000001 -3 7\n\n" << "1 2 3\n";
+  }
+  const auto loaded = CompGeom::loadIntPoints<3> ( file );
+  std::remove ( file.c_str() );
+  WVPASS ( loaded.exact() && loaded.size() == 2 && loaded[0].x == 40000001 );
+
+  // A turn of one unit on a 26 bit grid, floats can't tell
+  const int32_t m = 33554430;
+  WVPASS ( CompGeom::orient2DExact ( CompGeom::IVec2{0,0}, CompGeom::IVec2{m+1,m}, CompGeom::IVec2{m,m-1} ) == -1 );
+  WVPASS ( CompGeom::orient2DExact ( CompGeom::IVec2{0,0}, CompGeom::IVec2{m,m}, CompGeom::IVec2{m-1,m-1} ) == 0 );
+
+  // The integer determinant agrees with the double one, which is exact
+  std::default_random_engine         gen ( 91 );
+  std::uniform_int_distribution<int> coord ( -(1<<INTBITS)+1, (1<<INTBITS)-1 );
+  bool agree = true;
+  for ( int k=0; k<1000; k++ ) {
+    CompGeom::IVec3 v[4];
+    double          d[4][3];
+    for ( int i=0; i<4; i++ ) {
+      v[i] = { coord(gen), coord(gen), coord(gen) };
+      if ( i == 3 && k % 2 ) v[3] = { v[0].x + v[1].x - v[2].x, v[0].y + v[1].y - v[2].y, v[0].z };
+      for ( int a=0; a<3; a++ ) d[i][a] = v[i][a];
+    }
+    agree &= CompGeom::orient3DExact ( v[0], v[1], v[2], v[3] ) == CompGeom::orient3DExact ( d[0], d[1], d[2], d[3] );
+  }
+  WVPASS ( agree );
+
+  // The hulls match the float versions on integers floats hold exactly
+  CompGeom::Geometry geom3 ( 3 );
+  geom3.addRandom ( 20000 );
+  const auto ints3 = CompGeom::quantize<3> ( geom3, 20 );
+  CompGeom::Points<3> floats3;
+  for ( size_t i=0; i<ints3.size(); i++ )
+    floats3.push_back ( CompGeom::Vec3 { float(ints3.x(i)), float(ints3.y(i)), float(ints3.z(i)) } );
+  const auto tris = insertion3D ( ints3 );
+  WVPASS ( tris == insertion3D ( floats3 ) );
+  CompGeom::HullWorkspace ws;
+  WVPASS ( sortedTriangles ( gHullSerial ( ints3, ws, EDT_CPU, 128 ) ) == sortedTriangles ( tris ) );
+
+  // Small grids, nearly every point is coplanar with others or repeated
+  const std::pair < int, int > grids[] = { { 200, 5 }, { 2000, 20 } };
+  for ( const auto &g : grids ) {
+    CompGeom::IntPoints<3> grid;
+    for ( int i=0; i<g.first; i++ )
+      grid.push_back ( CompGeom::IVec3 { int32_t ( gen() % (g.second+1) ), int32_t ( gen() % (g.second+1) ),
+					 int32_t ( gen() % (g.second+1) ) } );
+    WVPASS ( isClosedHull ( gHullSerial ( grid, ws, EDT_CPU, 128 ), grid ) );
+  }
+
+  CompGeom::Geometry geom2 ( 2 );
+  geom2.addRandom ( 20000 );
+  const auto ints2 = CompGeom::quantize<2> ( geom2, 20 );
+  CompGeom::Points<2> floats2;
+  for ( size_t i=0; i<ints2.size(); i++ )
+    floats2.push_back ( CompGeom::Vec2 { float(ints2.x(i)), float(ints2.y(i)) } );
+  auto wrapped = giftWrap ( ints2 ), expected = giftWrap ( floats2 );
+  wrapped.pop_back(); std::sort ( wrapped.begin(), wrapped.end() );
+  expected.pop_back(); std::sort ( expected.begin(), expected.end() );
+  WVPASS ( wrapped == expected );
+  WVPASS ( grahamScan ( ints2 ) == grahamScan ( floats2 ) );
+}